@@ -0,0 +1,46 @@
+#pragma once
+#define CEBU_INCLUDED_BENCH_BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <string_view>
+
+namespace cebu::bench
+{
+
+/// `files` - The corpus files given on the command line.
+using files = std::span<char* const>;
+
+/// `measure` - Returns the fastest of `runs` timings of `fn` in seconds.
+template<typename Fn>
+double measure(Fn&& fn, int runs = 5)
+{
+    double best{std::numeric_limits<double>::max()};
+    for (int i{0}; i < runs; ++i) {
+        auto start{std::chrono::steady_clock::now()};
+        fn();
+        std::chrono::duration<double> elapsed{
+            std::chrono::steady_clock::now() - start
+        };
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+/// `report` - Prints the throughput of processing `bytes` in `seconds`.
+inline void report(std::string_view name, std::size_t bytes, double seconds)
+{
+    std::cout << std::format("{:<48} {:>10.1f} MB/s\n",
+                             name, static_cast<double>(bytes) / seconds / 1e6);
+}
+
+/// `keep` - Prevents the computation of `value` from being optimized away.
+template<typename T>
+void keep(T const& value) noexcept
+{ asm volatile("" : : "r,m"(value) : "memory"); }
+
+}
@@ -0,0 +1,46 @@
+#include <thread>
+
+#include <bench/bench.h>
+#include <bench/corpus.h>
+#include <cebu/parser.h>
+
+namespace cebu::bench
+{
+
+void chunked(files corpora)
+{
+    source_manager sources;
+    std::vector<file_id> inputs;
+    inputs.push_back(sources.assign("synthetic source",
+                                    source_corpus(256 << 20)));
+    for (char const* file_path : corpora)
+        inputs.push_back(sources.assign(file_path, read_corpus(file_path)));
+
+    // The files are loaded as the driver loads them with `-j threads`, on a
+    // pool of that many threads, and the thread count doubles from one up
+    // to the number of cores.  Every load reloads the literal table, so the
+    // time includes stitching the chunks' tables, which is done on one
+    // thread.  The lexer's diagnostics are discarded.
+    std::ostream discard{nullptr};
+    parser parser;
+    parser.set_diagnostics(discard).set_sources(sources);
+    unsigned cores{std::max(std::thread::hardware_concurrency(), 1u)};
+    for (file_id input : inputs) {
+        source const& source{sources.source(input)};
+        for (unsigned threads{1};; threads = std::min(threads * 2, cores)) {
+            thread_pool pool{threads};
+            report(std::format("{} with {} threads", source.file_path(),
+                               threads),
+                   source.size(),
+                   measure([&] {
+                       parser.load<batch_option, parallel_option>(input,
+                                                                  pool);
+                       keep(parser.tokens().size());
+                   }, 3));
+            if (threads == cores)
+                break;
+        }
+    }
+}
+
+}
@@ -0,0 +1,234 @@
+#pragma once
+#define CEBU_INCLUDED_BENCH_CORPUS_H
+
+#include <format>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cebu/token.h>
+
+namespace cebu::bench
+{
+
+/// `identifier_corpus` - Generates about `size` bytes of whitespace-separated
+/// names drawn from a vocabulary of `vocabulary` names, one in ten of which is
+/// a keyword.
+inline std::string identifier_corpus(std::size_t size,
+                                     std::size_t vocabulary = 4096,
+                                     unsigned    seed = 1)
+{
+    static constexpr std::string_view head{
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_"
+    };
+    static constexpr std::string_view tail{
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789"
+    };
+
+    std::mt19937 random{seed};
+    std::vector<std::string> names(vocabulary);
+    for (std::string& name : names) {
+        name += head[random() % head.size()];
+        for (auto length{random() % 12}; length; --length)
+            name += tail[random() % tail.size()];
+    }
+
+    std::string corpus;
+    corpus.reserve(size + 64);
+    while (corpus.size() < size) {
+        if (random() % 10 == 0)
+            corpus += keywords[random() % keywords.size()].spelling;
+        else corpus += names[random() % names.size()];
+        corpus += random() % 8 ? ' ' : '\n';
+    }
+    return corpus;
+}
+
+/// `source_corpus` - Generates about `size` bytes of indented, source-like
+/// lines mixing names, keywords, numbers, strings and punctuators.
+inline std::string source_corpus(std::size_t size, unsigned seed = 1)
+{
+    static constexpr std::string_view strings[]{
+        "\"Hello, World!\"",
+        "\"a longer string literal that spans a good part of the line\"",
+        "\"escaped \\\"quotes\\\" and \\\\ backslashes\"",
+    };
+    static constexpr std::string_view operators[]{
+        " + ", " - ", " == ", " | ", " => ", ", ", ": "
+    };
+
+    std::mt19937 random{seed};
+    std::string names{identifier_corpus(64 * 1024, 512, seed)};
+    std::size_t cursor{0};
+    auto next_name{[&] {
+        // The names wrap around to the first once they run out.
+        std::size_t end{names.find_first_of(" \n", cursor)};
+        if (end == std::string::npos) {
+            cursor = 0;
+            end = names.find_first_of(" \n", cursor);
+        }
+        std::string_view name{names.data() + cursor, end - cursor};
+        cursor = end + 1;
+        return name;
+    }};
+
+    std::string corpus;
+    corpus.reserve(size + 256);
+    while (corpus.size() < size) {
+        corpus.append(4 * (1 + random() % 3), ' ');
+        corpus += next_name();
+        for (auto terms{1 + random() % 6}; terms; --terms) {
+            corpus += operators[random() % std::size(operators)];
+            switch (random() % 4) {
+            case 0:
+                corpus += std::to_string(random());
+                break;
+            case 1:
+                corpus += strings[random() % std::size(strings)];
+                break;
+            default:
+                corpus += next_name();
+                corpus += random() % 2 ? "(" : ")";
+            }
+        }
+        corpus += ";\n";
+    }
+    return corpus;
+}
+
+/// `declaration_corpus` - Generates about `size` bytes of method
+/// declarations with tuple and lambda types and empty bodies, in the style of
+/// `test2`.
+inline std::string declaration_corpus(std::size_t size, unsigned seed = 1)
+{
+    static constexpr std::string_view primitives[]{
+        "b8", "b16", "b32", "b64", "i8", "i16", "i32", "i64", "f32", "f64"
+    };
+
+    std::mt19937 random{seed};
+    auto type{[&](auto& type, std::string& out, unsigned depth) -> void {
+        if (depth > 1 || random() % 4) {
+            out += primitives[random() % std::size(primitives)];
+            return;
+        }
+        out += '(';
+        for (auto mappings{random() % 3}; mappings; --mappings) {
+            out += std::format("v{}: ", random() % 100);
+            type(type, out, depth + 1);
+            if (mappings > 1)
+                out += ", ";
+        }
+        out += ')';
+        if (random() % 2) {
+            out += " -> ";
+            type(type, out, depth + 1);
+        }
+    }};
+
+    std::string corpus;
+    corpus.reserve(size + 256);
+    while (corpus.size() < size) {
+        corpus += std::format("method m{}(", random() % 10000);
+        for (auto parameters{random() % 4}; parameters; --parameters) {
+            corpus += std::format("n{}: ", random() % 100);
+            type(type, corpus, 0);
+            if (parameters > 1)
+                corpus += ", ";
+        }
+        corpus += ") -> ";
+        type(type, corpus, 0);
+        corpus += random() % 2 ? ";\n" : " {\n}\n";
+    }
+    return corpus;
+}
+
+/// `expression_corpus` - Generates about `size` bytes of expression
+/// statements of `terms` operands each, mixing every binary operator with
+/// literals, paths, invocations and shallow parentheses.
+inline std::string expression_corpus(std::size_t size,
+                                     std::size_t terms,
+                                     unsigned    seed = 1)
+{
+    static constexpr std::string_view operators[]{" + ", " - ", " == ", " | "};
+
+    std::mt19937 random{seed};
+    auto operand{[&](std::string& out) {
+        switch (random() % 6) {
+        case 0:
+            out += std::to_string(random() % 100000);
+            break;
+        case 1:
+            out += std::format("p{}::q{}", random() % 100, random() % 100);
+            break;
+        case 2:
+            out += std::format("m{}(n: x{}, {})", random() % 100,
+                               random() % 100, random() % 10);
+            break;
+        case 3:
+            out += std::format("(x{} + {})", random() % 100, random() % 10);
+            break;
+        default:
+            out += std::format("x{}", random() % 1000);
+        }
+    }};
+
+    std::string corpus;
+    corpus.reserve(size + 64 * terms);
+    while (corpus.size() < size) {
+        operand(corpus);
+        for (std::size_t term{1}; term < terms; ++term) {
+            corpus += operators[random() % std::size(operators)];
+            operand(corpus);
+        }
+        corpus += ";\n";
+    }
+    return corpus;
+}
+
+/// `nested_expression_corpus` - Generates about `size` bytes of expression
+/// statements nested `depth` levels deep in parentheses, invocations and
+/// implications.
+inline std::string nested_expression_corpus(std::size_t size,
+                                            std::size_t depth,
+                                            unsigned    seed = 1)
+{
+    std::mt19937 random{seed};
+    std::string corpus;
+    std::vector<std::string> closers;
+    corpus.reserve(size + 32 * depth);
+    while (corpus.size() < size) {
+        for (std::size_t level{0}; level < depth; ++level)
+            switch (random() % 3) {
+            case 0:
+                corpus += std::format("x{} + (", random() % 100);
+                closers.push_back(")");
+                break;
+            case 1:
+                corpus += std::format("m{}(n: ", random() % 100);
+                closers.push_back(")");
+                break;
+            default:
+                corpus += std::format("x{} == {} => ", random() % 100,
+                                      random() % 10);
+                closers.push_back(std::format(", {}", random() % 10));
+            }
+        corpus += "x";
+        for (; !closers.empty(); closers.pop_back())
+            corpus += closers.back();
+        corpus += ";\n";
+    }
+    return corpus;
+}
+
+/// `read_corpus` - Returns the contents of the file at `file_path`.
+inline std::string read_corpus(char const* file_path)
+{
+    std::ifstream file{file_path, std::ios::binary};
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+}
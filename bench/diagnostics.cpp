@@ -0,0 +1,123 @@
+#include <cstdlib>
+#include <random>
+#include <sstream>
+
+#include <bench/bench.h>
+#include <bench/corpus.h>
+#include <cebu/parser.h>
+
+namespace cebu::bench
+{
+
+namespace
+{
+
+/// `damage` - Replaces about one in `period` characters of `source` with
+/// characters that don't lex, so that lexing errors are interleaved with the
+/// parsing errors that they cause.
+std::string damage(std::string source, std::size_t period)
+{
+    std::mt19937 random{1};
+    for (std::size_t i{random() % period}; i < source.size();
+         i += 1 + random() % (2 * period))
+        source[i] = random() % 2 ? '?' : '#';
+    return source;
+}
+
+/// `outcome` - The diagnostics of a parse as they were printed and as they
+/// were appended to the sink.
+struct outcome
+{
+    std::string             text;
+    std::vector<diagnostic> sink;
+};
+
+/// `diagnose` - Parses the first `declarations` declarations of `source`,
+/// or all of them if it is zero, then unloads it, and returns the
+/// diagnostics.
+template<typename ...Opts>
+outcome diagnose(std::string_view   name,
+                 std::string const& source,
+                 std::size_t        declarations = 0)
+{
+    outcome outcome;
+    std::ostringstream text;
+    cebu::parser parser;
+    parser.set_diagnostics(text).set_sink(&outcome.sink);
+    parser.assign<Opts...>(name, source);
+    program out;
+    if (declarations == 0)
+        parser.parse(out);
+    else while (declarations-- && parser.lookahead() != token_type::end)
+        syntax_parser<program>::parse_next(parser, out);
+    parser.unload();
+    outcome.text = text.str();
+    return outcome;
+}
+
+/// `fail` - Prints what went wrong with `mode` and exits.
+[[noreturn]]
+void fail(std::string_view mode, std::string_view what)
+{
+    std::cout << std::format("{:<48} {}\n", mode, what) << std::flush;
+    std::exit(EXIT_FAILURE);
+}
+
+}
+
+void diagnostics(files corpora)
+{
+    struct corpus
+    {
+        std::string name;
+        std::string source;
+    };
+    std::vector<corpus> inputs;
+    inputs.push_back({"synthetic declarations",
+                      damage(declaration_corpus(8 << 20), 4096)});
+    for (char const* file_path : corpora)
+        inputs.push_back({file_path, read_corpus(file_path)});
+
+    // The lexing modes are performance switches, so every mode must print
+    // the same diagnostics in the same order, and append them to the sink in
+    // that order too.
+    for (corpus const& input : inputs) {
+        outcome streamed{diagnose<>(input.name, input.source)};
+        auto compare{[&](std::string_view mode, outcome const& outcome) {
+            auto same{[](diagnostic const& left, diagnostic const& right) {
+                return left.offset == right.offset
+                    && left.message == right.message;
+            }};
+            std::string name{std::format("{} ({})", input.name, mode)};
+            if (outcome.text != streamed.text)
+                fail(name, "printed other diagnostics than streamed lexing");
+            if (!std::ranges::equal(outcome.sink, streamed.sink, same))
+                fail(name, "sank other diagnostics than streamed lexing");
+            std::cout << std::format("{:<48} {:>10} diagnostics\n", name,
+                                     outcome.sink.size());
+        }};
+        compare("streamed", streamed);
+        compare("batch", diagnose<batch_option>(input.name, input.source));
+        compare("parallel",
+                diagnose<batch_option, parallel_option>(input.name,
+                                                        input.source));
+        compare("pipeline", diagnose<pipeline_option>(input.name,
+                                                      input.source));
+
+        // A pipeline that is unloaded before the end has lexed ahead of the
+        // parser, so it prints what streamed lexing prints, then the
+        // diagnostics of the tokens that it lexed ahead.
+        static constexpr std::size_t declarations{64};
+        outcome ahead{diagnose<pipeline_option>(input.name, input.source,
+                                                declarations)};
+        outcome prefix{diagnose<>(input.name, input.source, declarations)};
+        std::string name{std::format("{} (pipeline unloaded early)",
+                                     input.name)};
+        if (!ahead.text.starts_with(prefix.text))
+            fail(name, "dropped diagnostics of streamed lexing");
+        std::cout << std::format("{:<48} {:>10} diagnostics\n", name,
+                                 ahead.sink.size());
+    }
+}
+
+}
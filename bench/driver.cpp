@@ -0,0 +1,52 @@
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include <bench/bench.h>
+#include <bench/corpus.h>
+#include <cebu/driver.h>
+
+namespace cebu::bench
+{
+
+void driver(files corpora)
+{
+    // The synthetic files are written to a temporary directory so that the
+    // driver loads them like any other files.
+    std::vector<std::string> owned;
+    std::filesystem::path directory{
+        std::filesystem::temp_directory_path() / "cebu-bench-driver"
+    };
+    if (corpora.empty()) {
+        std::filesystem::create_directories(directory);
+        for (unsigned i{0}; i < 256; ++i) {
+            owned.push_back(directory / std::format("{}.cb", i));
+            std::ofstream{owned.back(), std::ios::binary}
+                << declaration_corpus(64 << 10, i + 1);
+        }
+    } else owned.assign(corpora.begin(), corpora.end());
+
+    std::vector<std::string_view> file_paths{owned.begin(), owned.end()};
+    std::size_t bytes{0};
+    for (std::string const& file_path : owned)
+        bytes += std::filesystem::file_size(file_path);
+
+    // The thread count doubles from one up to the number of cores.  With
+    // files spread evenly over the threads, the throughput should double
+    // with it.
+    unsigned cores{std::max(std::thread::hardware_concurrency(), 1u)};
+    for (unsigned threads{1};; threads = std::min(threads * 2, cores)) {
+        cebu::driver driver{threads};
+        report(std::format("{} files with -j {}", file_paths.size(),
+                           threads),
+               bytes,
+               measure([&] { keep(driver.parse<map_option>(file_paths)); }));
+        if (threads == cores)
+            break;
+    }
+
+    if (corpora.empty())
+        std::filesystem::remove_all(directory);
+}
+
+}
@@ -0,0 +1,60 @@
+#include <random>
+
+#include <bench/bench.h>
+#include <bench/corpus.h>
+#include <cebu/document.h>
+
+namespace cebu::bench
+{
+
+void edit(files corpora)
+{
+    struct corpus
+    {
+        std::string name;
+        std::string source;
+    };
+    std::vector<corpus> inputs;
+    inputs.push_back({"synthetic 1 MB", declaration_corpus(1 << 20)});
+    inputs.push_back({"synthetic 16 MB", declaration_corpus(16 << 20)});
+    for (char const* file_path : corpora)
+        inputs.push_back({file_path, read_corpus(file_path)});
+
+    // Each keystroke types a character at a random offset then deletes it,
+    // which damages a token and repairs it again.  The latency of an edit is
+    // compared with parsing the whole source again.
+    static constexpr int keystrokes{500};
+    std::ostringstream diagnostics;
+    for (corpus const& input : inputs) {
+        document document;
+        document.set_diagnostics(diagnostics);
+        double full{measure([&] {
+            document.assign(input.name, input.source);
+        }, 3)};
+
+        std::mt19937 random{1};
+        std::vector<double> latencies;
+        document_change change;
+        for (int i{0}; i < keystrokes; ++i) {
+            auto offset{static_cast<std::uint32_t>(
+                random() % input.source.size()
+            )};
+            latencies.push_back(measure([&] {
+                document.edit(offset, 0, "x", change);
+            }, 1));
+            latencies.push_back(measure([&] {
+                document.edit(offset, 1, {}, change);
+            }, 1));
+            diagnostics.str({});
+        }
+        std::ranges::sort(latencies);
+        std::cout << std::format(
+            "{:<48} {:>10.3f} ms median, {:.3f} ms p99, {:.3f} ms full\n",
+            input.name,
+            latencies[latencies.size() / 2] * 1e3,
+            latencies[latencies.size() * 99 / 100] * 1e3,
+            full * 1e3);
+    }
+}
+
+}
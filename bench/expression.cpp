@@ -0,0 +1,65 @@
+#include <bench/bench.h>
+#include <bench/corpus.h>
+#include <cebu/parser.h>
+
+namespace cebu::bench
+{
+
+namespace
+{
+
+/// `parse_all` - Parses every expression statement of `parser`'s source and
+/// returns the number of statements.
+std::size_t parse_all(parser& parser)
+{
+    std::size_t count{0};
+    while (!parser.failed() && parser.lookahead() != token_type::end) {
+        expression expression;
+        parser
+            .parse<cebu::expression>(expression)
+            .expect<token_type::semicolon>();
+        ++count;
+    }
+    return count;
+}
+
+}
+
+void expression(files corpora)
+{
+    struct corpus
+    {
+        std::string name;
+        std::string source;
+    };
+    // The given files should only contain expression statements.
+    std::vector<corpus> inputs;
+    inputs.push_back({"short expressions",
+                      expression_corpus(8 << 20, 4)});
+    inputs.push_back({"long expressions",
+                      expression_corpus(8 << 20, 4096)});
+    inputs.push_back({"nested expressions",
+                      nested_expression_corpus(8 << 20, 64)});
+    inputs.push_back({"deeply nested expressions",
+                      nested_expression_corpus(8 << 20, 16384)});
+    for (char const* file_path : corpora)
+        inputs.push_back({file_path, read_corpus(file_path)});
+
+    // The source is lexed before each timing so that only parsing is timed.
+    // Reloading the source also releases the arena.
+    cebu::parser parser;
+    for (corpus const& input : inputs) {
+        double best{std::numeric_limits<double>::max()};
+        for (int i{0}; i < 5; ++i) {
+            parser.assign<batch_option>(input.name, input.source);
+            best = std::min(best, measure([&] {
+                keep(parse_all(parser));
+            }, 1));
+        }
+        report(std::format("{} ({} arena bytes)", input.name,
+                           parser.arena().statistics().bytes),
+               input.source.size(), best);
+    }
+}
+
+}
@@ -0,0 +1,167 @@
+#include <bench/bench.h>
+#include <bench/corpus.h>
+#include <cebu/flat_syntax.h>
+#include <cebu/parser.h>
+
+namespace cebu::bench
+{
+
+namespace
+{
+
+/// `sum_pointer_tree` - Sums the integer literals of the expression
+/// statements of `program` by walking the pointers of its nodes.
+std::uint64_t sum_pointer_tree(program const& program)
+{
+    std::vector<expression const*> stack;
+    auto push_binary{[&](auto const* operation) {
+        stack.push_back(&operation->left);
+        stack.push_back(&operation->right);
+    }};
+
+    std::uint64_t sum{0};
+    for (declaration const& declaration : program.declarations) {
+        body const& body{declaration.type == declaration::method
+            ? declaration.value.method->body
+            : declaration.value.value->body};
+        for (statement const& statement : body.statements)
+            if (statement.type == statement::expression)
+                stack.push_back(&statement.value.expression);
+
+        while (!stack.empty()) {
+            expression const& expression{*stack.back()};
+            stack.pop_back();
+            auto const& value{expression.value};
+            switch (expression.type) {
+            case expression::integer:
+                sum += static_cast<std::uint64_t>(value.integer->value);
+                break;
+            case expression::parenthesized:
+                stack.push_back(&value.parenthesized->expression);
+                break;
+            case expression::invocation:
+                for (mapping const& argument : value.invocation->arguments)
+                    stack.push_back(&argument.value);
+                break;
+            case expression::addition:
+                push_binary(value.addition);
+                break;
+            case expression::subtraction:
+                push_binary(value.subtraction);
+                break;
+            case expression::equation:
+                push_binary(value.equation);
+                break;
+            case expression::disjunction:
+                push_binary(value.disjunction);
+                break;
+            case expression::implication:
+                stack.push_back(&value.implication->condition);
+                stack.push_back(&value.implication->consequence);
+                stack.push_back(&value.implication->contrapositive);
+                break;
+            case expression::assignment:
+                stack.push_back(&value.assignment->value);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    return sum;
+}
+
+/// `sum_flat_tree` - Sums the integer literals of `tree` by walking its
+/// array of expressions.
+std::uint64_t sum_flat_tree(flat::tree const& tree)
+{
+    auto const& numbers{tree.nodes<std::uint64_t>()};
+    std::uint64_t sum{0};
+    for (flat::expression const& expression : tree.nodes<flat::expression>())
+        if (expression.kind == expression::integer)
+            sum += numbers[expression.value];
+    return sum;
+}
+
+/// `value_corpus` - Makes a value declaration of each expression statement
+/// of `statements`.
+std::string value_corpus(std::string_view statements)
+{
+    std::string corpus;
+    corpus.reserve(statements.size() + statements.size() / 4);
+    std::size_t count{0};
+    for (std::size_t line{0}; line < statements.size();) {
+        std::size_t end{statements.find('\n', line)};
+        if (end == std::string_view::npos)
+            end = statements.size();
+        corpus += std::format("v{}: i64 = ", count++);
+        corpus += statements.substr(line, end - line + 1);
+        line = end + 1;
+    }
+    return corpus;
+}
+
+}
+
+void flat(files corpora)
+{
+    struct corpus
+    {
+        std::string name;
+        std::string source;
+    };
+    // The chain is deeper than a recursive walk of the tree could go.
+    std::string chain{"v: i32 = a"};
+    for (int i{1}; i < 400'000; ++i)
+        chain += " + a";
+    chain += ";\n";
+
+    std::vector<corpus> inputs;
+    inputs.push_back({"short expressions",
+                      value_corpus(expression_corpus(8 << 20, 4))});
+    inputs.push_back({"long expressions",
+                      value_corpus(expression_corpus(8 << 20, 256))});
+    inputs.push_back({"one chain of 400000 terms", std::move(chain)});
+    for (char const* file_path : corpora)
+        inputs.push_back({file_path, read_corpus(file_path)});
+
+    // A whole-program pass over the flat tree walks one array, while the
+    // same pass over the pointer tree chases a pointer per node.  The
+    // serialized tree holds its names, so it is read back without the
+    // parser.
+    cebu::parser parser;
+    for (corpus const& input : inputs) {
+        program program;
+        parser
+            .assign<batch_option>(input.name, input.source)
+            .parse<cebu::program>(program);
+
+        flat::tree tree;
+        report(std::format("{} (flatten)", input.name), input.source.size(),
+               measure([&] {
+                   tree.clear();
+                   keep(tree.add(program));
+               }));
+        report(std::format("{} (pass over pointer tree)", input.name),
+               input.source.size(),
+               measure([&] { keep(sum_pointer_tree(program)); }));
+        report(std::format("{} (pass over flat tree)", input.name),
+               input.source.size(),
+               measure([&] { keep(sum_flat_tree(tree)); }));
+
+        std::vector<std::byte> serialized;
+        report(std::format("{} (serialize)", input.name), input.source.size(),
+               measure([&] {
+                   serialized.clear();
+                   tree.serialize(serialized);
+               }));
+        flat::tree copy;
+        report(std::format("{} (deserialize)", input.name),
+               input.source.size(),
+               measure([&] { keep(copy.deserialize(serialized)); }));
+        if (sum_flat_tree(copy) != sum_pointer_tree(program)) [[unlikely]]
+            std::cout << std::format("{}: the trees differ\n", input.name);
+    }
+}
+
+}
@@ -0,0 +1,80 @@
+#include <unordered_map>
+#include <vector>
+
+#include <bench/bench.h>
+#include <bench/corpus.h>
+#include <cebu/lexer.h>
+
+namespace cebu::bench
+{
+
+namespace
+{
+
+/// `legacy_keyword` - The lookup the lexer used before `keyword_table`: a
+/// runtime hash map whose miss path throws.
+token_type legacy_keyword(std::string_view word)
+{
+    [[clang::no_destroy]]
+    static std::unordered_map<std::string_view, token_type> const table{
+        [] {
+            std::unordered_map<std::string_view, token_type> table;
+            for (keyword const& k : keywords)
+                table.emplace(k.spelling, k.type);
+            return table;
+        }()
+    };
+    try {
+        return table.at(word);
+    } catch (std::out_of_range const&) {
+        return token_type::none;
+    }
+}
+
+std::vector<std::string_view> split(std::string const& corpus)
+{
+    std::vector<std::string_view> words;
+    std::size_t start{0};
+    for (std::size_t i{0}; i <= corpus.size(); ++i)
+        if (i == corpus.size() || corpus[i] == ' ' || corpus[i] == '\n') {
+            if (i > start)
+                words.emplace_back(corpus.data() + start, i - start);
+            start = i + 1;
+        }
+    return words;
+}
+
+}
+
+void keywords(files)
+{
+    std::string corpus{identifier_corpus(16 << 20)};
+    std::vector<std::string_view> words{split(corpus)};
+
+    auto lookup{[&](auto find) {
+        return [&, find] {
+            std::size_t found{0};
+            for (std::string_view word : words)
+                found += find(word) != token_type::none;
+            keep(found);
+        };
+    }};
+    report("keyword lookup (unordered_map, throwing)", corpus.size(),
+           measure(lookup(legacy_keyword)));
+    report("keyword lookup (perfect hash)", corpus.size(),
+           measure(lookup(find_keyword)));
+
+    source_manager sources;
+    file_id file{sources.assign("<identifiers>", corpus)};
+    report("lex identifiers", corpus.size(), measure([&] {
+        interner interner;
+        literal_table literals;
+        literals.load(sources.source(file).data(), interner);
+        lexer lexer;
+        lexer.load(sources, file, literals);
+        token token;
+        while (lexer.lex(token) && token != token_type::end);
+    }));
+}
+
+}
@@ -0,0 +1,57 @@
+#include <bench/bench.h>
+#include <bench/corpus.h>
+#include <cebu/lexer.h>
+
+namespace cebu::bench
+{
+
+namespace
+{
+
+/// `lex_all` - Lexes the source of `file` to the end and returns the number
+/// of tokens.
+std::size_t lex_all(source_manager const& sources, file_id file)
+{
+    interner interner;
+    literal_table literals;
+    literals.load(sources.source(file).data(), interner);
+    lexer lexer;
+    lexer.load(sources, file, literals);
+    token token;
+    std::size_t count{0};
+    while (lexer.lex(token) && token != token_type::end)
+        ++count;
+    return count;
+}
+
+}
+
+void lexer(files corpora)
+{
+    source_manager sources;
+    std::vector<file_id> inputs;
+    inputs.push_back(sources.assign("synthetic identifiers",
+                                    identifier_corpus(32 << 20)));
+    inputs.push_back(sources.assign("synthetic source",
+                                    source_corpus(32 << 20)));
+    for (char const* file_path : corpora)
+        inputs.push_back(sources.assign(file_path, read_corpus(file_path)));
+
+    static constexpr std::pair<scan_kernel, std::string_view> kernels[]{
+        {scan_kernel::scalar, "scalar"},
+        {scan_kernel::sse2, "sse2"},
+        {scan_kernel::avx2, "avx2"},
+    };
+    for (file_id input : inputs)
+        for (auto [kernel, kernel_name] : kernels) {
+            if (use_scan_kernel(kernel) != kernel)
+                continue;
+            source const& source{sources.source(input)};
+            report(std::format("{} ({})", source.file_path(), kernel_name),
+                   source.size(),
+                   measure([&] { keep(lex_all(sources, input)); }));
+        }
+    use_scan_kernel(scan_kernel::best);
+}
+
+}
@@ -0,0 +1,63 @@
+#include <cstring>
+
+#include <bench/bench.h>
+
+/// Benchmarks for the front end.
+///
+/// # Usage
+///
+/// cebu-bench [benchmark] [corpus...]
+///
+/// Runs `benchmark`, or every benchmark if it is omitted.  Benchmarks that
+/// accept a corpus also measure the given files.  Build in release mode for
+/// meaningful numbers.
+
+namespace cebu::bench
+{
+
+void keywords(files);
+void lexer(files);
+void parser(files);
+void expression(files);
+void driver(files);
+void pipeline(files);
+void chunked(files);
+void edit(files);
+void flat(files);
+void server(files);
+void diagnostics(files);
+
+}
+
+using namespace cebu;
+
+int main(int argc, char** argv)
+{
+    struct benchmark
+    {
+        char const* name;
+        void (*run)(bench::files);
+    };
+    static constexpr benchmark benchmarks[]{
+        {"keywords", bench::keywords},
+        {"lexer", bench::lexer},
+        {"parser", bench::parser},
+        {"expression", bench::expression},
+        {"driver", bench::driver},
+        {"pipeline", bench::pipeline},
+        {"chunked", bench::chunked},
+        {"edit", bench::edit},
+        {"flat", bench::flat},
+        {"server", bench::server},
+        {"diagnostics", bench::diagnostics},
+    };
+
+    char const* selected{argc > 1 ? argv[1] : nullptr};
+    bench::files corpora{argv + std::min(argc, 2), argv + argc};
+    for (benchmark const& benchmark : benchmarks) {
+        if (selected && std::strcmp(selected, benchmark.name) != 0)
+            continue;
+        std::cout << std::format("# {}\n", benchmark.name);
+        benchmark.run(corpora);
+    }
+}
@@ -0,0 +1,144 @@
+#include <functional>
+
+#include <bench/bench.h>
+#include <bench/corpus.h>
+#include <cebu/parser.h>
+
+namespace cebu::bench
+{
+
+namespace
+{
+
+//
+// Declaration grammar
+//
+// A copy of the grammar of method signatures that can take its callbacks
+// either as they are or wrapped in `std::function`s, which is how the
+// combinators took them before they became templates.  Both versions do the
+// same work otherwise.
+//
+
+template<bool Erased, typename Fn = nothing>
+auto callback(Fn fn = {})
+{
+    if constexpr(Erased)
+        return std::function<void()>{std::move(fn)};
+    else return fn;
+}
+
+template<bool Erased>
+void parse_type(parser& parser);
+
+template<bool Erased>
+void parse_tuple(parser& parser)
+{
+    parser.expect<token_type::left_parenthesis, on_success_option>(
+        callback<Erased>([&] {
+            bool proceed{parser.lookahead() != token_type::right_parenthesis};
+            if (!proceed)
+                parser.consume(callback<Erased>(), callback<Erased>());
+            while (proceed) {
+                if (parser.lookahead() == token_type::name) {
+                    parser.expect<token_type::name>(callback<Erased>(),
+                                                    callback<Erased>());
+                    parser.expect<token_type::colon>(callback<Erased>(),
+                                                     callback<Erased>());
+                }
+                parse_type<Erased>(parser);
+                parser.expect<token_set{
+                    token_type::comma,
+                    token_type::right_parenthesis
+                }, on_success_option, on_failure_option>(callback<Erased>([&] {
+                    proceed = parser.token() != token_type::right_parenthesis;
+                }), callback<Erased>([&] { proceed = false; }));
+            }
+        }), callback<Erased>());
+}
+
+template<bool Erased>
+void parse_type(parser& parser)
+{
+    if (parser.lookahead() == token_type::left_parenthesis) {
+        parse_tuple<Erased>(parser);
+        if (parser.lookahead() == token_type::rightwards_arrow) {
+            parser.consume(callback<Erased>(), callback<Erased>());
+            parse_type<Erased>(parser);
+        }
+        return;
+    }
+    parser.expect<primitive_type_tokens>(callback<Erased>(),
+                                         callback<Erased>());
+}
+
+template<bool Erased>
+void parse_declaration(parser& parser)
+{
+    parser.expect<token_type::method>(callback<Erased>(), callback<Erased>());
+    parser.expect<token_type::name>(callback<Erased>(), callback<Erased>());
+    parse_tuple<Erased>(parser);
+    parser.expect<token_type::rightwards_arrow>(callback<Erased>(),
+                                                callback<Erased>());
+    parse_type<Erased>(parser);
+    parser.expect<token_set{
+        token_type::semicolon,
+        token_type::left_curly_bracket
+    }, on_success_option>(callback<Erased>([&] {
+        if (parser.token() == token_type::left_curly_bracket)
+            parser.expect<token_type::right_curly_bracket>(
+                callback<Erased>(), callback<Erased>());
+    }), callback<Erased>());
+}
+
+/// `parse_all` - Parses every declaration of `parser`'s source and returns
+/// the number of declarations.
+template<bool Erased>
+std::size_t parse_all(parser& parser)
+{
+    std::size_t count{0};
+    while (!parser.failed() && parser.lookahead() != token_type::end) {
+        parse_declaration<Erased>(parser);
+        ++count;
+    }
+    return count;
+}
+
+}
+
+void parser(files corpora)
+{
+    struct corpus
+    {
+        std::string name;
+        std::string source;
+    };
+    // Parsing stops at the first error, so the given files should only
+    // contain declarations that the grammar above accepts.
+    std::vector<corpus> inputs;
+    inputs.push_back({"synthetic declarations", declaration_corpus(8 << 20)});
+    for (char const* file_path : corpora)
+        inputs.push_back({file_path, read_corpus(file_path)});
+
+    // The source is lexed before each timing so that only parsing is timed.
+    cebu::parser parser;
+    auto measure_parse{[&]<bool Erased>(corpus const& input) {
+        double best{std::numeric_limits<double>::max()};
+        for (int i{0}; i < 5; ++i) {
+            parser.assign<batch_option>(input.name, input.source);
+            best = std::min(best, measure([&] {
+                keep(parse_all<Erased>(parser));
+            }, 1));
+        }
+        return best;
+    }};
+    for (corpus const& input : inputs) {
+        report(std::format("{} (std::function callbacks)", input.name),
+               input.source.size(),
+               measure_parse.template operator()<true>(input));
+        report(std::format("{} (template callbacks)", input.name),
+               input.source.size(),
+               measure_parse.template operator()<false>(input));
+    }
+}
+
+}
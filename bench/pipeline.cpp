@@ -0,0 +1,51 @@
+#include <bench/bench.h>
+#include <bench/corpus.h>
+#include <cebu/parser.h>
+
+namespace cebu::bench
+{
+
+void pipeline(files corpora)
+{
+    struct corpus
+    {
+        std::string name;
+        std::string source;
+    };
+    // Pipelining only pays off on files that take long to lex, so the
+    // synthetic file is large.  The given files should only contain
+    // declarations.
+    std::vector<corpus> inputs;
+    inputs.push_back({"synthetic declarations",
+                      declaration_corpus(200 << 20)});
+    for (char const* file_path : corpora)
+        inputs.push_back({file_path, read_corpus(file_path)});
+
+    // Both modes copy the source in and parse the whole program, so the
+    // difference between them is the time that lexing overlapped parsing.
+    cebu::parser parser;
+    auto measure_parse{[&]<typename ...Opts>(corpus const& input) {
+        return measure([&] {
+            program program;
+            parser
+                .assign<Opts...>(input.name, input.source)
+                .template parse<cebu::program>(program);
+            keep(program.declarations.size());
+        }, 3);
+    }};
+    for (corpus const& input : inputs) {
+        double streamed{measure_parse.template operator()<>(input)};
+        double pipelined{
+            measure_parse.template operator()<pipeline_option>(input)
+        };
+        report(std::format("{} (streamed)", input.name),
+               input.source.size(), streamed);
+        report(std::format("{} (pipelined)", input.name),
+               input.source.size(), pipelined);
+        std::cout << std::format("{:<48} {:>10.3f} s ({:.1f}%)\n",
+                                 "overlap saved", streamed - pipelined,
+                                 (streamed - pipelined) / streamed * 100);
+    }
+}
+
+}
@@ -0,0 +1,105 @@
+#include <random>
+
+#include <bench/bench.h>
+#include <bench/corpus.h>
+#include <cebu/server.h>
+
+namespace cebu::bench
+{
+
+void server(files corpora)
+{
+    struct corpus
+    {
+        std::string name;
+        std::string source;
+    };
+    std::vector<corpus> inputs;
+    inputs.push_back({"synthetic 1 MB", declaration_corpus(1 << 20)});
+    for (char const* file_path : corpora)
+        inputs.push_back({file_path, read_corpus(file_path)});
+
+    auto frame{[](json const& message) {
+        std::string content;
+        message.dump(content);
+        return std::format("Content-Length: {}\r\n\r\n{}",
+                           content.size(), content);
+    }};
+
+    // Each message is sent to a resident server, which answers from the
+    // documents that it keeps, as an editor would between keystrokes.  A
+    // keystroke types a character at the start of a random line, and the
+    // round trip includes publishing the diagnostics.
+    static constexpr int keystrokes{200};
+    for (corpus const& input : inputs) {
+        cebu::server server;
+        std::ostringstream out;
+        auto send{[&](json const& message) {
+            std::istringstream in{frame(message)};
+            out.str({});
+            (void)server.run(in, out);
+        }};
+        send(json{}.set("id", 1).set("method", "initialize"));
+
+        std::string uri{std::format("file:///{}", input.name)};
+        double open{measure([&] {
+            send(json{}
+                .set("method", "textDocument/didOpen")
+                .set("params", json{}.set("textDocument", json{}
+                    .set("uri", uri)
+                    .set("text", input.source))));
+        }, 3)};
+
+        std::size_t lines{static_cast<std::size_t>(
+            std::ranges::count(input.source, '\n')
+        )};
+        std::mt19937 random{1};
+        std::vector<double> changes;
+        for (int i{0}; i < keystrokes; ++i) {
+            std::size_t line{random() % lines};
+            json start{json{}.set("line", line).set("character", 0)};
+            json end{json{}.set("line", line).set("character", 1)};
+            changes.push_back(measure([&] {
+                send(json{}
+                    .set("method", "textDocument/didChange")
+                    .set("params", json{}
+                        .set("textDocument", json{}.set("uri", uri))
+                        .set("contentChanges", json::array_type{json{}
+                            .set("range", json{}
+                                .set("start", start)
+                                .set("end", start))
+                            .set("text", "x")})));
+            }, 1));
+            changes.push_back(measure([&] {
+                send(json{}
+                    .set("method", "textDocument/didChange")
+                    .set("params", json{}
+                        .set("textDocument", json{}.set("uri", uri))
+                        .set("contentChanges", json::array_type{json{}
+                            .set("range", json{}
+                                .set("start", start)
+                                .set("end", end))
+                            .set("text", "")})));
+            }, 1));
+        }
+        std::ranges::sort(changes);
+
+        double symbols{measure([&] {
+            send(json{}
+                .set("id", 2)
+                .set("method", "textDocument/documentSymbol")
+                .set("params", json{}.set("textDocument", json{}
+                    .set("uri", uri))));
+        }, 3)};
+        std::cout << std::format(
+            "{:<48} {:>10.3f} ms change median, {:.3f} ms p99, "
+            "{:.3f} ms symbols, {:.3f} ms open\n",
+            input.name,
+            changes[changes.size() / 2] * 1e3,
+            changes[changes.size() * 99 / 100] * 1e3,
+            symbols * 1e3,
+            open * 1e3);
+    }
+}
+
+}
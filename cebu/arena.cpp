@@ -0,0 +1,55 @@
+#include "arena.h"
+
+namespace cebu
+{
+
+void arena::release() noexcept
+{
+    for (auto it{this->m_finalizers.rbegin()};
+         it != this->m_finalizers.rend(); ++it)
+        it->destroy(it->node);
+    this->m_finalizers.clear();
+    this->m_blocks.clear();
+    this->m_cursor = nullptr;
+    this->m_remaining = 0;
+    this->m_statistics.bytes = 0;
+    this->m_statistics.nodes = 0;
+    this->m_statistics.reserved = 0;
+}
+
+void arena::rewind(arena_mark const& mark) noexcept
+{
+    while (this->m_finalizers.size() > mark.finalizers) {
+        finalizer const& last{this->m_finalizers.back()};
+        last.destroy(last.node);
+        this->m_finalizers.pop_back();
+    }
+    this->m_blocks.resize(mark.blocks);
+    this->m_cursor = mark.cursor;
+    this->m_remaining = mark.remaining;
+    this->m_statistics.bytes = mark.statistics.bytes;
+    this->m_statistics.nodes = mark.statistics.nodes;
+    this->m_statistics.reserved = mark.statistics.reserved;
+}
+
+void* arena::allocate_block(std::size_t size)
+{
+    // Blocks are aligned for any node, so only the size matters.  Nodes that
+    // would waste most of a block get a block of their own.
+    if (size > block_size / 4) [[unlikely]] {
+        this->m_statistics.reserved += size;
+        this->count(size);
+        return this->m_blocks.emplace_back(new std::byte[size]).get();
+    }
+
+    this->m_cursor = this->m_blocks.emplace_back(new std::byte[block_size])
+                                   .get();
+    this->m_remaining = block_size - size;
+    this->m_statistics.reserved += block_size;
+    this->count(size);
+    void* node{this->m_cursor};
+    this->m_cursor += size;
+    return node;
+}
+
+}
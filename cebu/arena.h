@@ -0,0 +1,200 @@
+#pragma once
+#define CEBU_INCLUDED_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cebu
+{
+
+/// `arena_statistics` - The allocation statistics of an `arena`.
+struct arena_statistics
+{
+    /// The bytes allocated since the arena was last released.
+    std::size_t bytes{0};
+
+    /// The nodes made since the arena was last released.
+    std::size_t nodes{0};
+
+    /// The bytes of the blocks held by the arena.
+    std::size_t reserved{0};
+
+    /// The most bytes that were ever allocated at once.
+    std::size_t high_water{0};
+};
+
+/// `arena_mark` - A position of an `arena` that it can be rewound to.
+struct arena_mark
+{
+    std::size_t      blocks{0};
+    std::size_t      finalizers{0};
+    std::byte*       cursor{nullptr};
+    std::size_t      remaining{0};
+    arena_statistics statistics;
+};
+
+/// `arena` - A bump allocator for syntax trees.
+///
+/// Nodes are allocated from large blocks by bumping a cursor and are all
+/// freed at once when the arena is released or destroyed.  Nodes that are
+/// not trivially destructible, such as those holding a `std::vector`, are
+/// destroyed in the reverse order of their construction first.
+class arena
+{
+public:
+    arena() = default;
+    arena(arena const&) = delete;
+    arena& operator=(arena const&) = delete;
+
+    arena(arena&& other) noexcept
+    { *this = std::move(other); }
+
+    arena& operator=(arena&& other) noexcept
+    {
+        if (this == &other) [[unlikely]]
+            return *this;
+        this->release();
+        this->m_blocks = std::move(other.m_blocks);
+        this->m_finalizers = std::move(other.m_finalizers);
+        this->m_cursor = std::exchange(other.m_cursor, nullptr);
+        this->m_remaining = std::exchange(other.m_remaining, 0);
+        this->m_statistics = std::exchange(other.m_statistics, {});
+        return *this;
+    }
+
+    ~arena()
+    { this->release(); }
+
+    /// `make` - Constructs a `T` from `args` in the arena.
+    template<typename T, typename ...Args>
+    T* make(Args&&... args)
+    {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        T* node{::new(this->allocate(sizeof(T), alignof(T)))
+            T(std::forward<Args>(args)...)};
+        if constexpr(!std::is_trivially_destructible_v<T>)
+            this->m_finalizers.push_back({
+                node,
+                [](void* node) { static_cast<T*>(node)->~T(); }
+            });
+        ++this->m_statistics.nodes;
+        return node;
+    }
+
+    /// `copy` - Copies `values` into the arena and returns the copy.
+    ///
+    /// # Notes
+    ///
+    /// Arrays are not finalized, so their elements must be trivially
+    /// destructible.
+    template<typename T>
+    std::span<T> copy(std::span<T const> values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>
+                      && std::is_trivially_destructible_v<T>);
+        if (values.empty())
+            return {};
+        T* data{static_cast<T*>(this->allocate(values.size_bytes(),
+                                               alignof(T)))};
+        std::uninitialized_copy(values.begin(), values.end(), data);
+        return {data, values.size()};
+    }
+
+    /// `allocate` - Returns `size` uninitialized bytes aligned to
+    /// `alignment`, which must be a power of two.
+    [[nodiscard]]
+    void* allocate(std::size_t size, std::size_t alignment)
+    {
+        auto cursor{reinterpret_cast<std::uintptr_t>(this->m_cursor)};
+        auto padding{-cursor & (alignment - 1)};
+        if (padding + size > this->m_remaining) [[unlikely]]
+            return this->allocate_block(size);
+
+        this->m_cursor += padding + size;
+        this->m_remaining -= padding + size;
+        this->count(padding + size);
+        return reinterpret_cast<void*>(cursor + padding);
+    }
+
+    /// `release` - Destroys every node and frees the blocks.
+    ///
+    /// # Notes
+    ///
+    /// The high-water mark is kept.
+    void release() noexcept;
+
+    /// `mark` - Returns the position of the cursor, which `rewind` returns
+    /// to.
+    [[nodiscard]]
+    arena_mark mark() const noexcept
+    {
+        return {
+            this->m_blocks.size(),
+            this->m_finalizers.size(),
+            this->m_cursor,
+            this->m_remaining,
+            this->m_statistics
+        };
+    }
+
+    /// `rewind` - Destroys the nodes made after `mark` and moves the cursor
+    /// back to it.
+    ///
+    /// # Notes
+    ///
+    /// The blocks that were added after `mark` are freed.  The high-water
+    /// mark is kept.
+    void rewind(arena_mark const& mark) noexcept;
+
+    /// `statistics` - Returns the allocation statistics.
+    [[nodiscard]]
+    arena_statistics const& statistics() const noexcept
+    { return this->m_statistics; }
+
+private:
+    static constexpr std::size_t block_size{64 * 1024};
+
+    struct finalizer
+    {
+        void* node;
+        void  (*destroy)(void*);
+    };
+
+    std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+    std::vector<finalizer>                    m_finalizers;
+    std::byte*                                m_cursor{nullptr};
+    std::size_t                               m_remaining{0};
+    arena_statistics                          m_statistics;
+
+    void* allocate_block(std::size_t size);
+
+    void count(std::size_t size) noexcept
+    {
+        this->m_statistics.bytes += size;
+        this->m_statistics.high_water = std::max(
+            this->m_statistics.high_water, this->m_statistics.bytes);
+    }
+};
+
+}
+
+template<>
+struct std::formatter<cebu::arena_statistics>
+    : formatter<string>
+{
+    auto format(cebu::arena_statistics const& self, format_context& ctx) const
+    {
+        return formatter<string>::format(std::format(
+            "{} nodes, {} bytes ({} reserved, {} high-water)",
+            self.nodes, self.bytes, self.reserved, self.high_water
+        ), ctx);
+    }
+};
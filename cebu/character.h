@@ -0,0 +1,92 @@
+#pragma once
+#define CEBU_INCLUDED_CHARACTER_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace cebu
+{
+
+/// `character_class` - The lexical classes a character can belong to.
+///
+/// A character can belong to more than one class, so the classes are bits.
+struct character_class
+{
+    enum : std::uint8_t
+    {
+        none       = 0,
+        whitespace = 1 << 0,
+        name_start = 1 << 1,
+        name       = 1 << 2,
+        digit      = 1 << 3,
+        punctuator = 1 << 4
+    };
+};
+
+/// `character_classes` - The classes of every character, indexed by its
+/// unsigned value.
+///
+/// Unlike the `<cctype>` functions, this does not depend on the locale and
+/// is defined for negative `char`s.
+inline constexpr std::array<std::uint8_t, 256> character_classes{[] {
+    std::array<std::uint8_t, 256> classes{};
+    auto add{[&](std::string_view characters, unsigned bits) {
+        for (char c : characters)
+            classes[static_cast<unsigned char>(c)]
+                |= static_cast<std::uint8_t>(bits);
+    }};
+    add(" \t\n\v\f\r", character_class::whitespace);
+    add("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_",
+        character_class::name_start | character_class::name);
+    add("0123456789", character_class::digit | character_class::name);
+    add("=+-|@,:;()[]<>{}*/%", character_class::punctuator);
+    return classes;
+}()};
+
+/// `digit_values` - The value of every character as a digit, or 16 if it is
+/// not a digit in any supported radix.
+inline constexpr std::array<std::uint8_t, 256> digit_values{[] {
+    std::array<std::uint8_t, 256> values;
+    values.fill(16);
+    for (std::uint8_t i{0}; i < 10; ++i)
+        values['0' + i] = i;
+    for (std::uint8_t i{0}; i < 6; ++i) {
+        values['a' + i] = static_cast<std::uint8_t>(10 + i);
+        values['A' + i] = static_cast<std::uint8_t>(10 + i);
+    }
+    return values;
+}()};
+
+/// `classify` - Returns the classes of `character`.
+[[nodiscard]]
+constexpr std::uint8_t classify(char character) noexcept
+{ return character_classes[static_cast<unsigned char>(character)]; }
+
+[[nodiscard]]
+constexpr bool is_whitespace(char character) noexcept
+{ return classify(character) & character_class::whitespace; }
+
+[[nodiscard]]
+constexpr bool is_name_start(char character) noexcept
+{ return classify(character) & character_class::name_start; }
+
+[[nodiscard]]
+constexpr bool is_name(char character) noexcept
+{ return classify(character) & character_class::name; }
+
+[[nodiscard]]
+constexpr bool is_digit(char character) noexcept
+{ return classify(character) & character_class::digit; }
+
+[[nodiscard]]
+constexpr bool is_punctuator(char character) noexcept
+{ return classify(character) & character_class::punctuator; }
+
+/// `digit_value` - Returns the value of `character` as a digit, or 16 if it
+/// is not a digit in any supported radix.
+[[nodiscard]]
+constexpr unsigned digit_value(char character) noexcept
+{ return digit_values[static_cast<unsigned char>(character)]; }
+
+}
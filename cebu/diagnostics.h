@@ -1,10 +1,12 @@
 #pragma once
 #define CEBU_INCLUDED_DIAGNOSTICS_H
 
+#include <cstdint>
 #include <utility>
 #include <format>
 #include <functional>
 #include <iostream>
+#include <string>
 #include <string_view>
 
 namespace cebu
@@ -34,12 +36,32 @@ struct std::formatter<cebu::position>
 namespace cebu
 {
 
+/// `location` - A decoded source location.
 struct location
 {
     std::string_view file_path;
     position         position;
 };
 
+/// `source_location` - A location encoded as an offset into the source space
+/// of a `source_manager`.
+///
+/// It is only decoded into a `location` when a diagnostic is printed.  The
+/// zero location belongs to no file.
+enum class source_location : std::uint32_t {};
+
+/// `diagnostic` - A diagnostic of a source, for tools that present the
+/// diagnostics themselves rather than print them.
+struct diagnostic
+{
+    /// The offset into the source of what the diagnostic is about.
+    std::uint32_t offset;
+
+    /// The message without the location, which starts with the kind of the
+    /// error, as in "parsing error: ...".
+    std::string   message;
+};
+
 }
 
 template<>
@@ -0,0 +1,438 @@
+#include <algorithm>
+#include <span>
+
+#include "document.h"
+
+namespace cebu
+{
+
+namespace
+{
+
+/// `relocator` - Moves the locations of syntax trees by a number of
+/// locations, so that trees parsed before an edit locate into the edited
+/// source.
+///
+/// The nodes are visited as tasks of an explicit stack rather than by
+/// recursion, since the parser builds some trees, such as long chains of
+/// operators, iteratively and deeper than the native stack would allow.
+class relocator
+{
+public:
+    relocator() = default;
+
+    /// `relocate` - Moves the locations of `declaration` and of everything
+    /// in it by `shift`.
+    void relocate(declaration& declaration, std::uint32_t shift)
+    {
+        this->m_shift = shift;
+        this->push(declaration);
+        while (!this->m_tasks.empty()) {
+            task task{this->m_tasks.back()};
+            this->m_tasks.pop_back();
+            switch (task.kind) {
+            case task::declaration:
+                this->visit(*static_cast<cebu::declaration*>(task.node));
+                break;
+            case task::value:
+                this->visit(*static_cast<value_declaration*>(task.node));
+                break;
+            case task::type:
+                this->visit(*static_cast<cebu::type*>(task.node));
+                break;
+            case task::expression:
+                this->visit(*static_cast<cebu::expression*>(task.node));
+                break;
+            }
+        }
+    }
+
+private:
+    /// `task` - A node whose locations are to be moved.
+    struct task
+    {
+        enum kind_t : std::uint8_t
+        {
+            declaration,
+            value,
+            type,
+            expression
+        };
+
+        kind_t kind;
+        void*  node;
+    };
+
+    std::uint32_t     m_shift{0};
+    std::vector<task> m_tasks;
+
+    void push(declaration& declaration)
+    { this->m_tasks.push_back({task::declaration, &declaration}); }
+
+    void push(value_declaration& value)
+    { this->m_tasks.push_back({task::value, &value}); }
+
+    void push(type& type)
+    { this->m_tasks.push_back({task::type, &type}); }
+
+    void push(expression& expression)
+    { this->m_tasks.push_back({task::expression, &expression}); }
+
+    void push(body& body)
+    {
+        for (statement& statement : body.statements)
+            if (statement.type == statement::expression)
+                this->push(statement.value.expression);
+            else this->push(statement.value.declaration);
+    }
+
+    void relocate(identifier& identifier) noexcept
+    {
+        // The names of positional arguments have the zero location, which no
+        // token has.
+        if (identifier.location == source_location{})
+            return;
+        identifier.location = static_cast<source_location>(
+            static_cast<std::uint32_t>(identifier.location) + this->m_shift
+        );
+    }
+
+    void relocate(path& path) noexcept
+    {
+        for (identifier& identifier : path.value)
+            this->relocate(identifier);
+    }
+
+    void visit(declaration& declaration)
+    {
+        switch (declaration.type) {
+        case declaration::method: {
+            method_declaration& method{*declaration.value.method};
+            this->relocate(method.identifier);
+            for (value_declaration& mapping : method.lambda.tuple.mappings)
+                this->push(mapping);
+            this->push(method.lambda.return_type);
+            this->push(method.body);
+            break;
+        }
+        case declaration::value_:
+            this->visit(*declaration.value.value);
+            break;
+        }
+    }
+
+    void visit(value_declaration& value)
+    {
+        this->relocate(value.identifier);
+        this->push(value.type);
+        this->push(value.body);
+    }
+
+    void visit(type& type)
+    {
+        switch (type.type) {
+        case type::primitive:
+            break;
+        case type::tuple:
+            for (value_declaration& mapping : type.value.tuple->mappings)
+                this->push(mapping);
+            break;
+        case type::lambda:
+            for (value_declaration& mapping : type.value.lambda->tuple.mappings)
+                this->push(mapping);
+            this->push(type.value.lambda->return_type);
+            break;
+        }
+    }
+
+    void visit(expression& expression)
+    {
+        auto& value{expression.value};
+        switch (expression.type) {
+        case expression::integer:
+        case expression::decimal:
+        case expression::character:
+        case expression::string:
+            break;
+        case expression::parenthesized:
+            this->push(value.parenthesized->expression);
+            break;
+        case expression::path:
+            this->relocate(*value.path);
+            break;
+        case expression::invocation:
+            this->relocate(value.invocation->path);
+            for (mapping& argument : value.invocation->arguments) {
+                this->relocate(argument.name);
+                this->push(argument.value);
+            }
+            break;
+        case expression::cast:
+            this->relocate(value.cast->path);
+            this->push(value.cast->type);
+            break;
+        case expression::addition:
+            this->push(value.addition->left);
+            this->push(value.addition->right);
+            break;
+        case expression::subtraction:
+            this->push(value.subtraction->left);
+            this->push(value.subtraction->right);
+            break;
+        case expression::equation:
+            this->push(value.equation->left);
+            this->push(value.equation->right);
+            break;
+        case expression::disjunction:
+            this->push(value.disjunction->left);
+            this->push(value.disjunction->right);
+            break;
+        case expression::implication:
+            this->push(value.implication->condition);
+            this->push(value.implication->consequence);
+            this->push(value.implication->contrapositive);
+            break;
+        case expression::assignment:
+            this->relocate(value.assignment->path);
+            this->push(value.assignment->value);
+            break;
+        }
+    }
+};
+
+/// `exhausted` - Returns whether the tables of `parser` that only grow as
+/// edits are lexed, which are those of the literal table and the interner,
+/// are more than half full.
+bool exhausted(parser const& parser) noexcept
+{
+    literal_mark literals{parser.literals().mark()};
+    return std::max({literals.numbers, literals.decimals, literals.strings})
+               > token::indirect / 2
+        || parser.interner().size() > (token::max_payload + 1) / 2;
+}
+
+}
+
+document::document()
+{ this->reset(); }
+
+cebu::program const& document::program()
+{
+    if (!std::exchange(this->m_moved, false))
+        return this->m_program;
+    relocator relocator;
+    for (std::size_t i{0}; i < this->m_spans.size(); ++i)
+        if (std::uint32_t shift{std::exchange(this->m_spans[i].shift, 0)})
+            relocator.relocate(this->m_program.declarations[i], shift);
+    return this->m_program;
+}
+
+void document::reset()
+{
+    this->m_parser = std::make_unique<cebu::parser>();
+    this->m_parser
+        ->set_diagnostics(*this->m_diagnostics)
+        .set_sink(this->m_sink)
+        .set_copy_strings(true);
+    this->m_program.declarations.clear();
+    this->m_spans.clear();
+    this->m_next_program.declarations.clear();
+    this->m_next_spans.clear();
+    this->m_holes.clear();
+    this->m_next_holes.clear();
+    this->m_lexing_errors.clear();
+    this->m_moved = false;
+}
+
+result document::load(std::string_view file_path)
+{
+    this->reset();
+    this->m_parser->load<batch_option>(file_path);
+    bool loaded{!this->m_parser->failed()};
+    this->parse({0, 0, this->m_parser->tokens().size()}, 0, false);
+    this->m_arena_bytes = this->m_parser->arena().statistics().bytes;
+    return loaded ? result::success : result::failure;
+}
+
+result document::assign(std::string_view file_path, std::string contents)
+{
+    this->reset();
+    this->m_parser->assign<batch_option>(file_path, std::move(contents));
+    this->parse({0, 0, this->m_parser->tokens().size()}, 0, false);
+    this->m_arena_bytes = this->m_parser->arena().statistics().bytes;
+    return this->m_parser->file() != file_id::none ? result::success
+                                                   : result::failure;
+}
+
+result document::edit(std::uint32_t    offset,
+                      std::uint32_t    removed,
+                      std::string_view inserted,
+                      document_change& change)
+{
+    std::size_t tokens{this->m_parser->tokens().size()};
+    std::size_t declarations{this->m_program.declarations.size()};
+    if (!this->m_parser->edit(offset, removed, inserted, change.tokens))
+        [[unlikely]]
+        return result::failure;
+
+    std::size_t garbage{
+        this->m_parser->arena().statistics().bytes - this->m_arena_bytes
+    };
+    if (garbage > std::max(compaction_floor,
+                           compaction_ratio * this->source().size())
+        || exhausted(*this->m_parser)) [[unlikely]] {
+        std::string file_path{this->m_parser->file_path()};
+        this->assign(file_path, std::string{this->source().view()});
+        change = {
+            {0, tokens, this->m_parser->tokens().size()},
+            {0, declarations, this->m_program.declarations.size()}
+        };
+        return result::success;
+    }
+    change.declarations = this->parse(
+        change.tokens,
+        static_cast<std::uint32_t>(inserted.size() - removed),
+        true
+    );
+    return result::success;
+}
+
+splice document::parse(splice const& tokens, std::uint32_t delta,
+                       bool relexed)
+{
+    // The program is parsed into the vectors of the one before last, which
+    // keeps large sources from faulting in new pages on every edit.
+    cebu::parser& parser{*this->m_parser};
+    cebu::program& program{this->m_next_program};
+    std::vector<span>& spans{this->m_next_spans};
+    std::vector<std::size_t>& holes{this->m_next_holes};
+    program.declarations.clear();
+    spans.clear();
+    holes.clear();
+    splice changed;
+    bool diverged{false};
+    auto diverge{[&] {
+        if (!std::exchange(diverged, true))
+            changed.first = program.declarations.size();
+    }};
+
+    // The tokens that report lexing errors are those of the old tokens that
+    // the edit kept, which move by the change in the number of tokens, and
+    // those of the new tokens, so only the new tokens are scanned.
+    std::ptrdiff_t moved_by{static_cast<std::ptrdiff_t>(tokens.inserted)
+                            - static_cast<std::ptrdiff_t>(tokens.removed)};
+    std::vector<std::size_t>& lexing_errors{this->m_lexing_errors};
+    auto replaced{std::ranges::lower_bound(lexing_errors, tokens.first)};
+    auto kept{std::ranges::lower_bound(lexing_errors,
+                                       tokens.first + tokens.removed)};
+    for (auto index{kept}; index != lexing_errors.end(); ++index)
+        *index += moved_by;
+    std::vector<std::size_t> found;
+    parser.find_lexing_errors(tokens.first, tokens.first + tokens.inserted,
+                              found);
+    lexing_errors.insert(lexing_errors.erase(replaced, kept),
+                         found.begin(), found.end());
+
+    // The lexer's diagnostics are printed in order with those of the
+    // declarations that are parsed again, as when the source is loaded.
+    if (relexed)
+        parser.report_lexing_errors(lexing_errors);
+
+    // The old declarations from `damaged` until `after` have tokens that the
+    // edit replaced.  The ones after move by the change in the number of
+    // tokens, and their locations by the change in size, which is left for
+    // `program` to apply.
+    auto damaged{static_cast<std::size_t>(
+        std::ranges::partition_point(this->m_spans, [&](span const& span) {
+            return span.last <= tokens.first;
+        }) - this->m_spans.begin()
+    )};
+    auto after{static_cast<std::size_t>(
+        std::ranges::partition_point(this->m_spans, [&](span const& span) {
+            return span.first < tokens.first + tokens.removed;
+        }) - this->m_spans.begin()
+    )};
+    auto reusable{[&](std::size_t index) noexcept {
+        return (index < damaged || index >= after)
+            && !this->m_spans[index].failed;
+    }};
+    auto first{[&](std::size_t index) noexcept {
+        return this->m_spans[index].first + (index >= after ? moved_by : 0);
+    }};
+
+    std::size_t next{0};
+    auto hole{this->m_holes.begin()};
+    parser.seek(0);
+    while (parser.lookahead() != token_type::end) {
+        // The old declarations that the edit damaged or that reported errors
+        // are parsed again, and the ones that the parse went past because
+        // the edit changed where a declaration ends are dropped.
+        std::size_t index{parser.index()};
+        for (; next < this->m_spans.size(); ++next) {
+            if (reusable(next) && first(next) >= index)
+                break;
+            diverge();
+            ++changed.removed;
+        }
+
+        // The declarations are reused until the next one that was parsed
+        // after tokens that no declaration was parsed from, or that the edit
+        // damaged or that reported errors.
+        if (next < this->m_spans.size() && first(next) == index) {
+            while (hole != this->m_holes.end() && *hole <= next)
+                ++hole;
+            std::size_t last{hole != this->m_holes.end()
+                             ? *hole : this->m_spans.size()};
+            if (next < damaged)
+                last = std::min(last, damaged);
+
+            auto& declarations{this->m_program.declarations};
+            program.declarations.insert(program.declarations.end(),
+                                        declarations.begin() + next,
+                                        declarations.begin() + last);
+            std::size_t reused{spans.size()};
+            spans.insert(spans.end(),
+                         this->m_spans.begin() + next,
+                         this->m_spans.begin() + last);
+            if (next >= after) {
+                for (span& span : std::span{spans}.subspan(reused)) {
+                    span.first += moved_by;
+                    span.last += moved_by;
+                    span.shift += delta;
+                }
+                this->m_moved |= delta != 0;
+            }
+            if (spans[reused].first != (reused ? spans[reused - 1].last : 0))
+                holes.push_back(reused);
+            next = last;
+            parser.seek(spans.back().last);
+            continue;
+        }
+
+        diverge();
+        std::size_t errors{parser.errors()};
+        if (syntax_parser<cebu::program>::parse_next(parser, program)) {
+            bool failed{parser.errors() > errors};
+            if (failed || index != (spans.empty() ? 0 : spans.back().last))
+                holes.push_back(spans.size());
+            spans.push_back({index, parser.index(), failed});
+            ++changed.inserted;
+        }
+    }
+    if (next < this->m_spans.size()) {
+        diverge();
+        changed.removed += this->m_spans.size() - next;
+    }
+    if (!diverged)
+        changed.first = program.declarations.size();
+    parser.flush_diagnostics();
+    if (parser.errors())
+        parser.set_failed();
+
+    std::swap(this->m_program, program);
+    std::swap(this->m_spans, spans);
+    std::swap(this->m_holes, holes);
+    return changed;
+}
+
+}
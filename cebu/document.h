@@ -0,0 +1,194 @@
+#pragma once
+#define CEBU_INCLUDED_DOCUMENT_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <cebu/parser.h>
+#include <cebu/syntax.h>
+#include <cebu/token_buffer.h>
+
+namespace cebu
+{
+
+/// `document_change` - What an edit of a `document` changed.
+struct document_change
+{
+    /// The tokens that were lexed again.
+    splice tokens;
+
+    /// The declarations that were parsed again, as indices into the
+    /// declarations of the program before and after the edit.
+    splice declarations;
+};
+
+/// `document` - A source that is kept parsed while it is edited.
+///
+/// The source is lexed into a token buffer, and the tokens that each
+/// declaration of the program was parsed from are remembered.  An edit lexes
+/// again only the tokens that it damaged, then parses from the first
+/// declaration that it damaged until the parse reaches the first token of
+/// an undamaged declaration.  The parser carries no state between
+/// declarations, so the rest of the program is the same and the trees of
+/// the undamaged declarations are reused.
+///
+/// Syntax that reported errors is parsed again on every edit, whether it was
+/// dropped or recovered from, so the diagnostics of the whole source are
+/// printed after each edit at the positions of the edited source.
+///
+/// The source is edited in place and string literals are copied into the
+/// arena, so the reused trees only need their locations after the edit
+/// moved.  That is left for `program`, so that a burst of edits moves each
+/// tree once rather than once per edit.
+///
+/// # Notes
+///
+/// The trees that were replaced stay in the arena, and the values of the
+/// tokens that were replaced stay in the literal table and interner.  Once
+/// the arena has grown by `compaction_ratio` times the size of the source,
+/// or any of the tables of values is more than half full, the source is
+/// parsed from scratch with a new parser.  A source whose own values fill
+/// half of a table is therefore parsed from scratch on every edit.
+class document
+{
+public:
+    /// How many times the size of the source the arena may grow by before
+    /// the source is parsed from scratch.
+    static constexpr std::size_t compaction_ratio{8};
+
+    /// The least that the arena may grow by before the source is parsed from
+    /// scratch.
+    static constexpr std::size_t compaction_floor{64 << 20};
+
+    document();
+
+    /// `load` - Loads and parses the file at `file_path`.
+    ///
+    /// Returns failure if the file could not be loaded.
+    result load(std::string_view file_path);
+
+    /// `assign` - Parses `contents` as the source of a file at `file_path`
+    /// that is not read from the disk.
+    ///
+    /// Returns failure if the source space is full.
+    result assign(std::string_view file_path, std::string contents);
+
+    /// `edit` - Replaces the `removed` characters at `offset` of the source
+    /// with `inserted` and parses the edited source, and sets `change` to
+    /// what was lexed and parsed again.
+    ///
+    /// Returns failure, having changed nothing, if the edit is out of the
+    /// source or the source space is full.
+    result edit(std::uint32_t    offset,
+                std::uint32_t    removed,
+                std::string_view inserted,
+                document_change& change);
+
+    /// `set_diagnostics` - Prints the diagnostics to `diagnostics` instead
+    /// of the standard error.
+    document& set_diagnostics(std::ostream& diagnostics) noexcept
+    {
+        this->m_diagnostics = &diagnostics;
+        this->m_parser->set_diagnostics(diagnostics);
+        return *this;
+    }
+
+    /// `set_sink` - Also appends the diagnostics to `sink`, unless it is
+    /// null.
+    document& set_sink(std::vector<diagnostic>* sink) noexcept
+    {
+        this->m_sink = sink;
+        this->m_parser->set_sink(sink);
+        return *this;
+    }
+
+    /// `program` - Moves the locations of the declarations that edits moved
+    /// since it was last called, then returns the program parsed from the
+    /// source.
+    [[nodiscard]]
+    cebu::program const& program();
+
+    /// `extent` - Returns the source offsets of the first and last tokens
+    /// of the declaration at `index` of the program.
+    [[nodiscard]]
+    std::pair<std::uint32_t, std::uint32_t>
+        extent(std::size_t index) const noexcept
+    {
+        auto const& tokens{this->m_parser->tokens()};
+        span const& span{this->m_spans[index]};
+        return {tokens.offset(span.first), tokens.offset(span.last - 1)};
+    }
+
+    /// `parser` - Returns the parser, which holds the source, tokens and
+    /// trees.
+    [[nodiscard]]
+    cebu::parser const& parser() const noexcept
+    { return *this->m_parser; }
+
+    /// `source` - Returns the source.
+    [[nodiscard]]
+    cebu::source const& source() const noexcept
+    { return this->m_parser->source(); }
+
+    /// `errors` - Returns the number of parsing errors of the source.
+    [[nodiscard]]
+    std::size_t errors() const noexcept
+    { return this->m_parser->errors(); }
+
+private:
+    /// `span` - The tokens that a declaration was parsed from.
+    struct span
+    {
+        std::size_t   first{0};
+        std::size_t   last{0};
+
+        /// Whether errors were recovered from inside the declaration.
+        bool          failed{false};
+
+        /// How far the locations of the declaration must move to locate into
+        /// the edited source.
+        std::uint32_t shift{0};
+    };
+
+    std::unique_ptr<cebu::parser> m_parser;
+    cebu::program                 m_program;
+
+    /// The tokens of each declaration of `m_program`.
+    std::vector<span>             m_spans;
+
+    /// The indices of the spans that reported errors or that follow tokens
+    /// that no declaration was parsed from, which are where reusing stops.
+    std::vector<std::size_t>      m_holes;
+
+    /// The program, spans and holes before the last edit, whose storage the
+    /// next edit reuses.
+    cebu::program                 m_next_program;
+    std::vector<span>             m_next_spans;
+    std::vector<std::size_t>      m_next_holes;
+
+    /// The indices of the tokens that report lexing errors, which are
+    /// lexed again to print their diagnostics after an edit.
+    std::vector<std::size_t>      m_lexing_errors;
+
+    std::ostream*                 m_diagnostics{&std::cerr};
+    std::vector<diagnostic>*      m_sink{nullptr};
+
+    /// Whether any declaration has locations left to move.
+    bool                          m_moved{false};
+
+    /// The bytes of the arena once the source was parsed from scratch.
+    std::size_t                   m_arena_bytes{0};
+
+    /// `reset` - Replaces the parser with a new one.
+    void reset();
+
+    /// `parse` - Parses the program from the tokens after `tokens` replaced
+    /// the ones of the previous program and the source changed in size by
+    /// `delta`.  The lexer's diagnostics are printed again if `relexed`.
+    splice parse(splice const& tokens, std::uint32_t delta, bool relexed);
+};
+
+}
@@ -0,0 +1,53 @@
+#include "driver.h"
+
+namespace cebu
+{
+
+std::vector<file_id> driver::load(std::span<std::string_view const> file_paths,
+                                  source_backend                    backend)
+{
+    // The files are read in parallel, which is where the time goes, then
+    // added in order, which only moves them.
+    std::vector<cebu::source> sources(file_paths.size());
+    std::unique_ptr<bool[]> loaded{new bool[file_paths.size()]};
+    this->m_pool.run(file_paths.size(), [&](std::size_t index) {
+        loaded[index] = sources[index].load(file_paths[index], backend);
+    });
+
+    this->m_sources = std::make_unique<source_manager>();
+    std::vector<file_id> files(file_paths.size(), file_id::none);
+    for (std::size_t i{0}; i < file_paths.size(); ++i)
+        if (loaded[i])
+            files[i] = this->m_sources->add(std::move(sources[i]));
+    return files;
+}
+
+void driver::print_diagnostics(std::ostream& out) const
+{
+    for (unit const& unit : this->units())
+        out << unit.diagnostics.view();
+    out.flush();
+}
+
+std::chrono::nanoseconds driver::overlap() const noexcept
+{
+    std::chrono::nanoseconds total{0};
+    for (unit const& unit : this->units())
+        total += unit.parser.overlap();
+    return total;
+}
+
+arena_statistics driver::arena_statistics() const noexcept
+{
+    cebu::arena_statistics total;
+    for (unit const& unit : this->units()) {
+        cebu::arena_statistics statistics{unit.parser.arena().statistics()};
+        total.bytes += statistics.bytes;
+        total.nodes += statistics.nodes;
+        total.reserved += statistics.reserved;
+        total.high_water += statistics.high_water;
+    }
+    return total;
+}
+
+}
@@ -0,0 +1,190 @@
+#pragma once
+#define CEBU_INCLUDED_DRIVER_H
+
+#include <chrono>
+#include <memory>
+#include <span>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+#include <cebu/parser.h>
+#include <cebu/source_manager.h>
+#include <cebu/syntax.h>
+#include <cebu/thread_pool.h>
+
+namespace cebu
+{
+
+/// `unit` - A source file and the program parsed from it.
+struct unit
+{
+    cebu::parser       parser;
+    cebu::program      program;
+
+    /// The diagnostics of the file, which are buffered so that they can be
+    /// printed in the order of the files.
+    std::ostringstream diagnostics;
+};
+
+/// `driver` - A front end that parses many files at once.
+///
+/// The files are loaded on the threads of a `thread_pool`, then added to a
+/// single `source_manager` in the order of their paths, so that every
+/// location of the build is unique and doesn't depend on the order in which
+/// the threads finish.  Each file is then parsed by a parser of its own on
+/// the threads of the pool, which also lex the files in chunks with
+/// `parallel_option`, so the driver never runs more threads than its pool.
+/// The parsers only read the shared manager, so nothing that is written is
+/// shared between the files while they are parsed.
+///
+/// # Notes
+///
+/// Each parser has its own interner, so the symbols of names are only
+/// comparable within a file.
+class driver
+{
+public:
+    /// `driver` - Makes a driver that parses on `threads` threads, or on one
+    /// thread per core if `threads` is zero.
+    explicit driver(unsigned threads = 0) noexcept
+        : m_pool{threads}
+    {}
+
+    /// `parse` - Replaces the units with those of the files at
+    /// `file_paths`, which are loaded and parsed in parallel.
+    ///
+    /// Returns failure if any file could not be loaded or parsed.
+    ///
+    /// # Options
+    ///
+    /// The options are those of `parser::load`, which choose how the files
+    /// are lexed.
+    template<typename ...Opts>
+    result parse(std::span<std::string_view const> file_paths);
+
+    /// `units` - Returns the units in the order of their files.
+    [[nodiscard]]
+    std::span<unit> units() noexcept
+    { return {this->m_units.get(), this->m_size}; }
+
+    [[nodiscard]]
+    std::span<unit const> units() const noexcept
+    { return {this->m_units.get(), this->m_size}; }
+
+    /// `print_diagnostics` - Prints the diagnostics of every unit to `out` in
+    /// the order of their files.
+    void print_diagnostics(std::ostream& out) const;
+
+    /// `time` - Returns the wall time that the last `parse` took.
+    [[nodiscard]]
+    std::chrono::nanoseconds time() const noexcept
+    { return this->m_time; }
+
+    /// `overlap` - Returns the time that lexing overlapped parsing summed
+    /// over the units, which is the time that parsing with `pipeline_option`
+    /// saved over lexing then parsing each file on one thread.
+    ///
+    /// # Notes
+    ///
+    /// The files are parsed in parallel, so with more than one thread the
+    /// wall time saved is less than the sum.
+    [[nodiscard]]
+    std::chrono::nanoseconds overlap() const noexcept;
+
+    /// `arena_statistics` - Returns the allocation statistics of the arenas
+    /// of every unit added together.
+    ///
+    /// # Notes
+    ///
+    /// The high-water mark is the sum of those of the units, which bounds
+    /// the most bytes that were allocated at once since the units are kept
+    /// together.
+    [[nodiscard]]
+    cebu::arena_statistics arena_statistics() const noexcept;
+
+    /// `sources` - Returns the manager of the sources of every unit, which
+    /// decodes their locations.
+    [[nodiscard]]
+    source_manager const& sources() const noexcept
+    { return *this->m_sources; }
+
+    /// `threads` - Returns the number of threads that files are parsed on.
+    [[nodiscard]]
+    unsigned threads() const noexcept
+    { return this->m_pool.size(); }
+
+private:
+    thread_pool                     m_pool;
+    std::unique_ptr<source_manager> m_sources{
+        std::make_unique<source_manager>()
+    };
+    std::unique_ptr<unit[]>         m_units;
+    std::size_t                     m_size{0};
+    std::chrono::nanoseconds        m_time{0};
+
+    /// `load` - Replaces the sources with those of the files at
+    /// `file_paths`, and returns their files, which are `file_id::none` for
+    /// the files that could not be loaded.
+    std::vector<file_id> load(std::span<std::string_view const> file_paths,
+                              source_backend                    backend);
+};
+
+template<typename ...Opts>
+result driver::parse(std::span<std::string_view const> file_paths)
+{
+    // The parsers of the old units point into the old sources, so they go
+    // first.  Units hold their parsers, which can't be moved, so they are
+    // made in place.
+    auto start{std::chrono::steady_clock::now()};
+    this->m_units.reset();
+    std::vector<file_id> files{this->load(
+        file_paths,
+        find_type_v<map_option, Opts...> ? source_backend::mapped
+                                         : source_backend::buffered)};
+    this->m_units.reset(new unit[file_paths.size()]);
+    this->m_size = file_paths.size();
+    for (unit& unit : this->units())
+        unit.parser
+            .set_diagnostics(unit.diagnostics)
+            .set_sources(*this->m_sources);
+
+    // The pool can't lex the chunks of a file from the task that parses it,
+    // so the files that are lexed in chunks are lexed first, one at a time on
+    // every thread, and the rest are lexed on one thread each as they are
+    // parsed.  Either way, the files are lexed on the threads of the pool.
+    // A pool of one thread runs the chunks on the calling thread, so the
+    // tasks can share one.
+    std::unique_ptr<bool[]> lexed{new bool[file_paths.size()]{}};
+    thread_pool single{1};
+    if constexpr(find_type_v<parallel_option, Opts...>)
+        for (std::size_t i{0}; i < file_paths.size(); ++i)
+            if (files[i] != file_id::none
+                && token_buffer::chunks(this->m_sources->source(files[i])
+                                            .size(),
+                                        this->m_pool.size()) > 1) {
+                this->m_units[i].parser.template load<Opts...>(files[i],
+                                                               this->m_pool);
+                lexed[i] = true;
+            }
+    this->m_pool.run(file_paths.size(), [&](std::size_t index) {
+        unit& unit{this->m_units[index]};
+        if (files[index] == file_id::none) [[unlikely]] {
+            unit.diagnostics << std::format(
+                "[{}] loading error: could not load file", file_paths[index])
+                << std::endl;
+            unit.parser.set_failed();
+            return;
+        }
+        if (!lexed[index])
+            unit.parser.template load<Opts...>(files[index], single);
+        unit.parser.template parse<program>(unit.program);
+    });
+    this->m_time = std::chrono::steady_clock::now() - start;
+    for (unit const& unit : this->units())
+        if (unit.parser.failed())
+            return result::failure;
+    return result::success;
+}
+
+}
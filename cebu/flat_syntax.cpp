@@ -0,0 +1,776 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+#include "flat_syntax.h"
+
+namespace cebu::flat
+{
+
+namespace
+{
+
+/// `magic` - The first bytes of a serialized tree.
+constexpr std::uint32_t magic{0x75626563};  // "cebu"
+
+template<typename Node>
+index<Node> push(std::vector<Node>& nodes, Node const& node)
+{
+    nodes.push_back(node);
+    return {static_cast<std::uint32_t>(nodes.size() - 1)};
+}
+
+}
+
+/// `flattener` - Appends the nodes of pointer-based syntax trees to a tree.
+///
+/// A parent reserves the slots of its children before any of them are
+/// flattened, so that the children of the same kind stay contiguous even
+/// though their own children are appended to the same arrays.  The children
+/// are then flattened into their slots as tasks of an explicit stack rather
+/// than by recursion, since the parser builds some trees, such as long
+/// chains of operators, iteratively and deeper than the native stack would
+/// allow.  Nodes are filled in by index, since the arrays grow as slots are
+/// reserved.
+class flattener
+{
+public:
+    explicit flattener(flat::tree& tree) noexcept
+        : m_tree{tree}
+    {}
+
+    /// `defer` - Reserves the slot of a `Node` and queues flattening `source`
+    /// into it.
+    template<typename Node, typename Source>
+    index<Node> defer(Source const& source)
+    { return {this->defer_each<Node>(std::span{&source, 1}).first}; }
+
+    /// `defer_each` - Reserves contiguous slots of `Node`s and queues
+    /// flattening each of `sources` into them.
+    template<typename Node, typename Sources>
+    range<Node> defer_each(Sources const& sources)
+    {
+        range<Node> range{this->reserve<Node>(std::size(sources))};
+        std::uint32_t slot{range.first};
+        for (auto const& source : sources)
+            this->m_tasks.push_back({kind_of<Node>(), slot++, &source});
+        return range;
+    }
+
+    /// `run` - Flattens the queued sources until there are none.
+    void run()
+    {
+        auto& tree{this->m_tree};
+        while (!this->m_tasks.empty()) {
+            task task{this->m_tasks.back()};
+            this->m_tasks.pop_back();
+            switch (task.kind) {
+            case task::type:
+                tree.nodes<type>()[task.slot] = this->flatten(
+                    *static_cast<cebu::type const*>(task.source));
+                break;
+            case task::value:
+                tree.nodes<value_declaration>()[task.slot] = this->flatten(
+                    *static_cast<cebu::value_declaration const*>(task.source));
+                break;
+            case task::method:
+                tree.nodes<method_declaration>()[task.slot] = this->flatten(
+                    *static_cast<cebu::method_declaration const*>(task.source));
+                break;
+            case task::declaration:
+                tree.nodes<declaration>()[task.slot] = this->flatten(
+                    *static_cast<cebu::declaration const*>(task.source));
+                break;
+            case task::body:
+                tree.nodes<body>()[task.slot] = this->flatten(
+                    *static_cast<cebu::body const*>(task.source));
+                break;
+            case task::statement:
+                tree.nodes<statement>()[task.slot] = this->flatten(
+                    *static_cast<cebu::statement const*>(task.source));
+                break;
+            case task::expression:
+                tree.nodes<expression>()[task.slot] = this->flatten(
+                    *static_cast<cebu::expression const*>(task.source));
+                break;
+            }
+        }
+    }
+
+private:
+    /// `task` - A source to flatten into the slot of a node.
+    struct task
+    {
+        enum kind_t : std::uint8_t
+        {
+            type,
+            value,
+            method,
+            declaration,
+            body,
+            statement,
+            expression
+        };
+
+        kind_t        kind;
+        std::uint32_t slot;
+        void const*   source;
+    };
+
+    flat::tree&         m_tree;
+    std::vector<task>   m_tasks;
+
+    /// The symbols of the tree by the symbols of the parser.
+    std::vector<symbol> m_symbols;
+
+    template<typename Node>
+    static constexpr task::kind_t kind_of() noexcept
+    {
+        if constexpr(std::is_same_v<Node, flat::type>)
+            return task::type;
+        else if constexpr(std::is_same_v<Node, value_declaration>)
+            return task::value;
+        else if constexpr(std::is_same_v<Node, method_declaration>)
+            return task::method;
+        else if constexpr(std::is_same_v<Node, declaration>)
+            return task::declaration;
+        else if constexpr(std::is_same_v<Node, flat::body>)
+            return task::body;
+        else if constexpr(std::is_same_v<Node, statement>)
+            return task::statement;
+        else return task::expression;
+    }
+
+    /// `reserve` - Reserves the slots of `size` `Node`s.
+    template<typename Node>
+    range<Node> reserve(std::size_t size)
+    {
+        auto& nodes{this->m_tree.nodes<Node>()};
+        range<Node> range{
+            static_cast<std::uint32_t>(nodes.size()),
+            static_cast<std::uint32_t>(size)
+        };
+        nodes.resize(nodes.size() + size);
+        return range;
+    }
+
+    identifier flatten(cebu::identifier const& identifier)
+    {
+        // The symbols of the parser are mapped to those of the tree once, so
+        // most names are not hashed again.  Positional arguments have the
+        // default name, whose symbol is not the parser's.
+        if (identifier.name.size == 0) [[unlikely]]
+            return {
+                this->m_tree.m_names.intern({}).symbol,
+                identifier.location
+            };
+        static constexpr auto none{static_cast<symbol>(~std::uint32_t{0})};
+        auto source{static_cast<std::uint32_t>(identifier.name.symbol)};
+        if (source >= this->m_symbols.size())
+            this->m_symbols.resize(source + 1, none);
+        symbol& name{this->m_symbols[source]};
+        if (name == none)
+            name = this->m_tree.m_names.intern(identifier.name.view()).symbol;
+        return {name, identifier.location};
+    }
+
+    type flatten(cebu::type const& type)
+    {
+        flat::type node{type.type, 0};
+        switch (type.type) {
+        case cebu::type::primitive:
+            node.value = static_cast<std::uint32_t>(type.value.primitive);
+            break;
+        case cebu::type::tuple:
+            node.value = push(this->m_tree.nodes<tuple_type>(), {
+                this->defer_each<value_declaration>(type.value.tuple->mappings)
+            }).value;
+            break;
+        case cebu::type::lambda:
+            node.value = this->add(*type.value.lambda).value;
+            break;
+        }
+        return node;
+    }
+
+    index<lambda_type> add(cebu::lambda_type const& lambda)
+    {
+        return push(this->m_tree.nodes<lambda_type>(), {
+            this->defer_each<value_declaration>(lambda.tuple.mappings),
+            this->defer<type>(lambda.return_type)
+        });
+    }
+
+    value_declaration flatten(cebu::value_declaration const& value)
+    {
+        // Mappings of tuple types have no body.
+        index<flat::body> body;
+        if (!value.body.statements.empty())
+            body = this->defer<flat::body>(value.body);
+        return {
+            this->flatten(value.identifier),
+            this->defer<type>(value.type),
+            body
+        };
+    }
+
+    method_declaration flatten(cebu::method_declaration const& method)
+    {
+        return {
+            this->flatten(method.identifier),
+            this->add(method.lambda),
+            this->defer<flat::body>(method.body)
+        };
+    }
+
+    declaration flatten(cebu::declaration const& declaration)
+    {
+        switch (declaration.type) {
+        case cebu::declaration::method:
+            return {declaration.type, this->defer<method_declaration>(
+                *declaration.value.method
+            ).value};
+        case cebu::declaration::value_:
+            return {declaration.type, this->defer<value_declaration>(
+                *declaration.value.value
+            ).value};
+        }
+        return {declaration.type, 0};
+    }
+
+    body flatten(cebu::body const& body)
+    { return {this->defer_each<statement>(body.statements)}; }
+
+    statement flatten(cebu::statement const& statement)
+    {
+        if (statement.type == cebu::statement::expression)
+            return {statement.type, this->defer<expression>(
+                statement.value.expression
+            ).value};
+        return {statement.type, this->defer<declaration>(
+            statement.value.declaration
+        ).value};
+    }
+
+    expression flatten(cebu::expression const& expression)
+    {
+        auto const& value{expression.value};
+        auto& tree{this->m_tree};
+        flat::expression node{expression.type, 0};
+        switch (expression.type) {
+        case cebu::expression::integer:
+            node.value = push(tree.nodes<std::uint64_t>(),
+                              static_cast<std::uint64_t>(value.integer->value)
+            ).value;
+            break;
+        case cebu::expression::decimal:
+            node.value = push(tree.nodes<double>(), value.decimal->value).value;
+            break;
+        case cebu::expression::character:
+            node.value = static_cast<unsigned char>(value.character->value);
+            break;
+        case cebu::expression::string: {
+            auto& characters{tree.nodes<char>()};
+            range<char> string{
+                static_cast<std::uint32_t>(characters.size()),
+                static_cast<std::uint32_t>(value.string->value.size())
+            };
+            characters.insert(characters.end(), value.string->value.begin(),
+                              value.string->value.end());
+            node.value = push(tree.nodes<range<char>>(), string).value;
+        } break;
+        case cebu::expression::parenthesized:
+            node.value = this->defer<flat::expression>(
+                value.parenthesized->expression
+            ).value;
+            break;
+        case cebu::expression::path:
+            node.value = this->add(*value.path).value;
+            break;
+        case cebu::expression::invocation: {
+            index<flat::path> path{this->add(value.invocation->path)};
+            auto const& sources{value.invocation->arguments};
+            range<mapping> arguments{this->reserve<mapping>(sources.size())};
+            for (std::uint32_t i{0}; i < arguments.size; ++i) {
+                mapping argument{
+                    this->flatten(sources[i].name),
+                    this->defer<flat::expression>(sources[i].value)
+                };
+                tree.nodes<mapping>()[arguments.first + i] = argument;
+            }
+            node.value = push(tree.nodes<invocation>(),
+                              {path, arguments}).value;
+        } break;
+        case cebu::expression::cast: {
+            index<flat::path> path{this->add(value.cast->path)};
+            index<type> type{this->defer<flat::type>(value.cast->type)};
+            node.value = push(tree.nodes<cast>(), {path, type}).value;
+        } break;
+        case cebu::expression::addition:
+            node.value = this->add({&value.addition->left,
+                                    &value.addition->right}).value;
+            break;
+        case cebu::expression::subtraction:
+            node.value = this->add({&value.subtraction->left,
+                                    &value.subtraction->right}).value;
+            break;
+        case cebu::expression::equation:
+            node.value = this->add({&value.equation->left,
+                                    &value.equation->right}).value;
+            break;
+        case cebu::expression::disjunction:
+            node.value = this->add({&value.disjunction->left,
+                                    &value.disjunction->right}).value;
+            break;
+        case cebu::expression::implication:
+            node.value = this->add({&value.implication->condition,
+                                    &value.implication->consequence,
+                                    &value.implication->contrapositive}).value;
+            break;
+        case cebu::expression::assignment: {
+            index<flat::path> path{this->add(value.assignment->path)};
+            index<flat::expression> assigned{
+                this->defer<flat::expression>(value.assignment->value)
+            };
+            node.value = push(tree.nodes<assignment>(),
+                              {path, assigned}).value;
+        } break;
+        }
+        return node;
+    }
+
+    index<operation>
+        add(std::initializer_list<cebu::expression const*> operands)
+    {
+        range<expression> range{this->reserve<expression>(operands.size())};
+        std::uint32_t slot{range.first};
+        for (cebu::expression const* operand : operands)
+            this->m_tasks.push_back({task::expression, slot++, operand});
+        return push(this->m_tree.nodes<operation>(), {range});
+    }
+
+    index<flat::path> add(cebu::path const& path)
+    {
+        range<identifier> identifiers{
+            this->reserve<identifier>(path.value.size())
+        };
+        for (std::uint32_t i{0}; i < identifiers.size; ++i)
+            this->m_tree.nodes<identifier>()[identifiers.first + i] =
+                this->flatten(path.value[i]);
+        return push(this->m_tree.nodes<flat::path>(), {identifiers});
+    }
+};
+
+/// `validator` - Checks the nodes of a tree that was read back from its
+/// serialized form, whose indices can't be trusted.
+///
+/// Each node is valid if its indices and ranges are within the arrays of
+/// their kinds, its kind is known, and its symbols are names of the tree.
+/// The tree is valid if its nodes are, and no node is its own descendant,
+/// since walkers of the tree would never end.
+class validator
+{
+public:
+    explicit validator(flat::tree const& tree) noexcept
+        : m_tree{tree}
+    {}
+
+    /// `validate` - Returns whether the tree is valid.
+    [[nodiscard]]
+    bool validate()
+    {
+        return std::apply([&](auto const&... nodes) {
+            return (std::ranges::all_of(nodes, std::ref(*this)) && ...);
+        }, this->m_tree.m_nodes) && this->acyclic();
+    }
+
+    bool operator()(identifier const& node) noexcept
+    {
+        return static_cast<std::uint32_t>(node.name)
+             < this->m_tree.m_names.size();
+    }
+
+    bool operator()(type const& node) noexcept
+    {
+        switch (raw(node.kind)) {
+        case cebu::type::primitive:
+            return node.value >= static_cast<std::uint32_t>(primitive_type::b8)
+                && node.value <= static_cast<std::uint32_t>(
+                                     primitive_type::f128);
+        case cebu::type::tuple:
+            return this->contains(index<tuple_type>{node.value});
+        case cebu::type::lambda:
+            return this->contains(index<lambda_type>{node.value});
+        }
+        return false;
+    }
+
+    bool operator()(tuple_type const& node) noexcept
+    { return this->contains(node.mappings); }
+
+    bool operator()(lambda_type const& node) noexcept
+    {
+        return this->contains(node.mappings)
+            && this->contains(node.return_type);
+    }
+
+    bool operator()(value_declaration const& node) noexcept
+    {
+        // Mappings of tuple types have no body.
+        return (*this)(node.identifier) && this->contains(node.type)
+            && (!node.body || this->contains(node.body));
+    }
+
+    bool operator()(method_declaration const& node) noexcept
+    {
+        return (*this)(node.identifier) && this->contains(node.lambda)
+            && this->contains(node.body);
+    }
+
+    bool operator()(declaration const& node) noexcept
+    {
+        switch (raw(node.kind)) {
+        case cebu::declaration::method:
+            return this->contains(index<method_declaration>{node.value});
+        case cebu::declaration::value_:
+            return this->contains(index<value_declaration>{node.value});
+        }
+        return false;
+    }
+
+    bool operator()(body const& node) noexcept
+    { return this->contains(node.statements); }
+
+    bool operator()(statement const& node) noexcept
+    {
+        switch (raw(node.kind)) {
+        case cebu::statement::expression:
+            return this->contains(index<expression>{node.value});
+        case cebu::statement::declaration:
+            return this->contains(index<declaration>{node.value});
+        }
+        return false;
+    }
+
+    bool operator()(expression const& node) noexcept
+    {
+        switch (raw(node.kind)) {
+        case cebu::expression::integer:
+            return this->contains(index<std::uint64_t>{node.value});
+        case cebu::expression::decimal:
+            return this->contains(index<double>{node.value});
+        case cebu::expression::character:
+            return node.value <= 0xFF;
+        case cebu::expression::string:
+            return this->contains(index<range<char>>{node.value});
+        case cebu::expression::parenthesized:
+            return this->contains(index<expression>{node.value});
+        case cebu::expression::path:
+            return this->contains(index<path>{node.value});
+        case cebu::expression::invocation:
+            return this->contains(index<invocation>{node.value});
+        case cebu::expression::cast:
+            return this->contains(index<cast>{node.value});
+        case cebu::expression::addition:
+        case cebu::expression::subtraction:
+        case cebu::expression::equation:
+        case cebu::expression::disjunction:
+            return this->operands(node.value, 2);
+        case cebu::expression::implication:
+            return this->operands(node.value, 3);
+        case cebu::expression::assignment:
+            return this->contains(index<assignment>{node.value});
+        }
+        return false;
+    }
+
+    bool operator()(path const& node) noexcept
+    { return this->contains(node.identifiers); }
+
+    bool operator()(mapping const& node) noexcept
+    { return (*this)(node.name) && this->contains(node.value); }
+
+    bool operator()(invocation const& node) noexcept
+    { return this->contains(node.path) && this->contains(node.arguments); }
+
+    bool operator()(cast const& node) noexcept
+    { return this->contains(node.path) && this->contains(node.type); }
+
+    bool operator()(operation const& node) noexcept
+    { return this->contains(node.operands); }
+
+    bool operator()(assignment const& node) noexcept
+    { return this->contains(node.path) && this->contains(node.value); }
+
+    bool operator()(program const& node) noexcept
+    { return this->contains(node.declarations); }
+
+    /// Numbers and decimals refer to nothing.
+    bool operator()(std::uint64_t) noexcept
+    { return true; }
+
+    bool operator()(double) noexcept
+    { return true; }
+
+    bool operator()(range<char> const& node) noexcept
+    { return this->contains(node); }
+
+    bool operator()(char) noexcept
+    { return true; }
+
+private:
+    using arrays = decltype(tree::m_nodes);
+
+    /// What `contains` does with the children besides checking them.
+    enum class pass
+    {
+        bounds,
+        count,
+        release
+    };
+
+    flat::tree const&          m_tree;
+    pass                       m_pass{pass::bounds};
+
+    /// Where the nodes of each kind begin in the order of `m_nodes`, by which
+    /// every node is numbered.
+    std::array<std::size_t, std::tuple_size_v<arrays> + 1> m_bases{};
+
+    /// The number of parents of each node that are left, and the nodes that
+    /// have none left.
+    std::vector<std::uint32_t> m_parents;
+    std::vector<std::size_t>   m_orphans;
+
+    /// `kind` - Returns the position of the array of `Node`s in `m_nodes`.
+    template<typename Node, std::size_t Kind = 0>
+    static constexpr std::size_t kind() noexcept
+    {
+        if constexpr(std::is_same_v<std::tuple_element_t<Kind, arrays>,
+                                    std::vector<Node>>)
+            return Kind;
+        else return kind<Node, Kind + 1>();
+    }
+
+    /// `acyclic` - Returns whether no node is its own descendant.
+    ///
+    /// The nodes without parents are removed with their edges until none
+    /// are left.  Any nodes that remain have parents among themselves, so
+    /// they are on or under a cycle.
+    bool acyclic()
+    {
+        std::size_t kinds{0};
+        std::apply([&](auto const&... nodes) {
+            ((this->m_bases[kinds + 1] = this->m_bases[kinds] + nodes.size(),
+              ++kinds), ...);
+        }, this->m_tree.m_nodes);
+        std::size_t size{this->m_bases[kinds]};
+
+        this->m_pass = pass::count;
+        this->m_parents.assign(size, 0);
+        std::apply([&](auto const&... nodes) {
+            (std::ranges::for_each(nodes, std::ref(*this)), ...);
+        }, this->m_tree.m_nodes);
+
+        this->m_pass = pass::release;
+        for (std::size_t node{0}; node < size; ++node)
+            if (this->m_parents[node] == 0)
+                this->m_orphans.push_back(node);
+        std::size_t removed{0};
+        while (!this->m_orphans.empty()) {
+            std::size_t node{this->m_orphans.back()};
+            this->m_orphans.pop_back();
+            this->visit(node);
+            ++removed;
+        }
+        return removed == size;
+    }
+
+    /// `visit` - Checks the node numbered `node`.
+    void visit(std::size_t node)
+    {
+        auto kind{static_cast<std::size_t>(
+            std::ranges::upper_bound(this->m_bases, node)
+            - this->m_bases.begin() - 1
+        )};
+        [&]<std::size_t ...Kinds>(std::index_sequence<Kinds...>) {
+            ((Kinds == kind
+              ? (void)(*this)(std::get<Kinds>(this->m_tree.m_nodes)
+                                  [node - this->m_bases[Kinds]])
+              : void()), ...);
+        }(std::make_index_sequence<std::tuple_size_v<arrays>>{});
+    }
+
+    /// `edge` - Counts or removes the edges to the `size` nodes from the
+    /// one numbered `first`, depending on the pass.
+    void edge(std::size_t first, std::size_t size)
+    {
+        if (this->m_pass == pass::count)
+            for (std::size_t node{first}; node < first + size; ++node)
+                ++this->m_parents[node];
+        else if (this->m_pass == pass::release)
+            for (std::size_t node{first}; node < first + size; ++node)
+                if (--this->m_parents[node] == 0)
+                    this->m_orphans.push_back(node);
+    }
+
+    template<typename Node>
+    bool contains(index<Node> index) noexcept
+    {
+        if (index.value >= this->m_tree.nodes<Node>().size()) [[unlikely]]
+            return false;
+        this->edge(this->m_bases[kind<Node>()] + index.value, 1);
+        return true;
+    }
+
+    template<typename Node>
+    bool contains(range<Node> range) noexcept
+    {
+        if (std::uint64_t{range.first} + range.size
+            > this->m_tree.nodes<Node>().size()) [[unlikely]]
+            return false;
+        this->edge(this->m_bases[kind<Node>()] + range.first, range.size);
+        return true;
+    }
+
+    /// `raw` - Returns the value of `kind` as an integer, since the kind of
+    /// a node that was read back may be no value of its enumeration.
+    template<typename Kind>
+    static std::underlying_type_t<Kind> raw(Kind const& kind) noexcept
+    {
+        std::underlying_type_t<Kind> value;
+        std::memcpy(&value, &kind, sizeof(value));
+        return value;
+    }
+
+    /// `operands` - Returns whether `operation` is the index of an operation
+    /// of `size` operands, since operators take their operands by position.
+    bool operands(std::uint32_t operation, std::uint32_t size) noexcept
+    {
+        return this->contains(index<flat::operation>{operation})
+            && this->m_tree.nodes<flat::operation>()[operation].operands.size
+               == size;
+    }
+};
+
+index<program> tree::add(cebu::program const& program)
+{
+    flattener flattener{*this};
+    range<declaration> declarations{
+        flattener.defer_each<declaration>(program.declarations)
+    };
+    flattener.run();
+    return push(this->nodes<flat::program>(), {declarations});
+}
+
+index<method_declaration> tree::add(cebu::method_declaration const& method)
+{
+    flattener flattener{*this};
+    index<method_declaration> root{
+        flattener.defer<method_declaration>(method)
+    };
+    flattener.run();
+    return root;
+}
+
+index<value_declaration> tree::add(cebu::value_declaration const& value)
+{
+    flattener flattener{*this};
+    index<value_declaration> root{flattener.defer<value_declaration>(value)};
+    flattener.run();
+    return root;
+}
+
+index<expression> tree::add(cebu::expression const& expression)
+{
+    flattener flattener{*this};
+    index<flat::expression> root{flattener.defer<flat::expression>(expression)};
+    flattener.run();
+    return root;
+}
+
+void tree::clear() noexcept
+{
+    this->m_names = {};
+    std::apply([](auto&... nodes) { (nodes.clear(), ...); }, this->m_nodes);
+}
+
+void tree::serialize(std::vector<std::byte>& out) const
+{
+    // The format is the magic number, then the number of names followed by
+    // the size and characters of each in the order of their symbols, then
+    // the size of each array followed by its nodes, in the order of
+    // `m_nodes`.
+    auto write{[&](void const* data, std::size_t size) {
+        auto const* bytes{static_cast<std::byte const*>(data)};
+        out.insert(out.end(), bytes, bytes + size);
+    }};
+    write(&magic, sizeof(magic));
+    auto names{static_cast<std::uint32_t>(this->m_names.size())};
+    write(&names, sizeof(names));
+    for (std::uint32_t i{0}; i < names; ++i) {
+        interned name{this->m_names.lookup(static_cast<symbol>(i))};
+        write(&name.size, sizeof(name.size));
+        write(name.data, name.size);
+    }
+    std::apply([&](auto const&... nodes) {
+        ([&](auto const& nodes) {
+            using node = std::remove_cvref_t<decltype(nodes)>::value_type;
+            static_assert(std::is_trivially_copyable_v<node>);
+            auto size{static_cast<std::uint32_t>(nodes.size())};
+            write(&size, sizeof(size));
+            write(nodes.data(), nodes.size() * sizeof(node));
+        }(nodes), ...);
+    }, this->m_nodes);
+}
+
+result tree::deserialize(std::span<std::byte const> in)
+{
+    this->clear();
+    auto read{[&](void* data, std::size_t size) {
+        if (size > in.size()) [[unlikely]]
+            return false;
+        if (size)
+            std::memcpy(data, in.data(), size);
+        in = in.subspan(size);
+        return true;
+    }};
+
+    std::uint32_t header;
+    if (!read(&header, sizeof(header)) || header != magic) [[unlikely]]
+        return result::failure;
+
+    // Names are interned in the order of their symbols, so they get their
+    // symbols back, unless a name repeats.
+    std::uint32_t names;
+    bool read_all{read(&names, sizeof(names))};
+    for (std::uint32_t i{0}; read_all && i < names; ++i) {
+        std::uint32_t size;
+        read_all = read(&size, sizeof(size)) && size <= in.size();
+        if (!read_all)
+            break;
+        std::string_view name{reinterpret_cast<char const*>(in.data()), size};
+        read_all = this->m_names.intern(name).symbol == static_cast<symbol>(i);
+        in = in.subspan(size);
+    }
+    read_all = read_all && std::apply([&](auto&... nodes) {
+        return ([&](auto& nodes) {
+            using node = std::remove_cvref_t<decltype(nodes)>::value_type;
+            std::uint32_t size;
+            if (!read(&size, sizeof(size))
+                || std::size_t{size} * sizeof(node) > in.size())
+                return false;
+            nodes.resize(size);
+            return read(nodes.data(), nodes.size() * sizeof(node));
+        }(nodes) && ...);
+    }, this->m_nodes);
+    if (!read_all || !in.empty() || !validator{*this}.validate())
+        [[unlikely]] {
+        this->clear();
+        return result::failure;
+    }
+    return result::success;
+}
+
+}
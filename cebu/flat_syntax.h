@@ -0,0 +1,273 @@
+#pragma once
+#define CEBU_INCLUDED_FLAT_SYNTAX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <cebu/diagnostics.h>
+#include <cebu/interner.h>
+#include <cebu/syntax.h>
+
+/// Flat syntax trees
+///
+/// The nodes of a flat tree are stored in one array per kind and refer to
+/// each other by 32-bit indices instead of pointers.  The children of a node
+/// that are of the same kind are stored next to each other and referred to by
+/// a range, so passes over a whole program walk the arrays linearly.  Every
+/// node is trivially copyable, so a tree is serialized by copying its arrays.
+///
+/// Names are interned again by the tree, and stored as symbols of its own
+/// interner, so a tree that is read back from its serialized form needs no
+/// parser to name things, and names of trees of many files compare as
+/// symbols.
+
+namespace cebu::flat
+{
+
+/// `index` - The index of a `Node` in the array of its kind.
+template<typename Node>
+struct index
+{
+    static constexpr std::uint32_t none{~std::uint32_t{0}};
+
+    std::uint32_t value{none};
+
+    explicit operator bool() const noexcept
+    { return this->value != none; }
+};
+
+/// `range` - Contiguous `Node`s in the array of their kind.
+template<typename Node>
+struct range
+{
+    std::uint32_t first{0};
+    std::uint32_t size{0};
+};
+
+struct type;
+struct tuple_type;
+struct lambda_type;
+struct value_declaration;
+struct method_declaration;
+struct declaration;
+struct body;
+struct statement;
+struct expression;
+struct path;
+struct mapping;
+struct invocation;
+struct cast;
+struct operation;
+struct assignment;
+
+struct identifier
+{
+    /// A symbol of the tree's interner.
+    symbol          name;
+    source_location location;
+};
+
+struct type
+{
+    cebu::type::type_t kind;
+
+    /// The `primitive_type` or the index of the `tuple_type` or
+    /// `lambda_type`.
+    std::uint32_t      value;
+};
+
+struct tuple_type
+{
+    range<value_declaration> mappings;
+};
+
+struct lambda_type
+{
+    range<value_declaration> mappings;
+    index<type>              return_type;
+};
+
+/// `value_declaration` - A value declaration, or a mapping of a tuple type
+/// without a body.
+struct value_declaration
+{
+    flat::identifier identifier;
+    index<flat::type> type;
+    index<flat::body> body;
+};
+
+struct method_declaration
+{
+    flat::identifier         identifier;
+    index<flat::lambda_type> lambda;
+    index<flat::body>        body;
+};
+
+struct declaration
+{
+    cebu::declaration::type_t kind;
+
+    /// The index of the `method_declaration` or `value_declaration`.
+    std::uint32_t             value;
+};
+
+struct body
+{
+    range<statement> statements;
+};
+
+struct statement
+{
+    cebu::statement::type_t kind;
+
+    /// The index of the `expression` or `declaration`.
+    std::uint32_t           value;
+};
+
+struct expression
+{
+    cebu::expression::type_t kind;
+
+    /// Depends on `kind`:
+    ///
+    /// - `integer`: The index of the value in the numbers.
+    /// - `decimal`: The index of the value in the decimals.
+    /// - `character`: The character.
+    /// - `string`: The index of the range of the characters in the strings.
+    /// - `parenthesized`: The index of the inner `expression`.
+    /// - `addition`, `subtraction`, `equation`, `disjunction`,
+    ///   `implication`: The index of the `operation`.
+    /// - Otherwise: The index of the node of the same name.
+    std::uint32_t            value;
+};
+
+struct path
+{
+    range<identifier> identifiers;
+};
+
+struct mapping
+{
+    identifier        name;
+    index<expression> value;
+};
+
+struct invocation
+{
+    index<flat::path> path;
+    range<mapping>    arguments;
+};
+
+struct cast
+{
+    index<flat::path> path;
+    index<flat::type> type;
+};
+
+/// `operation` - The operands of an operator, which are the left and right
+/// operands of a binary operator or the condition, consequence and
+/// contrapositive of an implication.
+struct operation
+{
+    range<expression> operands;
+};
+
+struct assignment
+{
+    index<flat::path> path;
+    index<expression> value;
+};
+
+struct program
+{
+    range<declaration> declarations;
+};
+
+/// `tree` - The arrays of the nodes of flat syntax trees.
+class tree
+{
+public:
+    tree() = default;
+
+    /// `nodes` - Returns the array of the `Node`s.
+    template<typename Node>
+    [[nodiscard]]
+    std::vector<Node>& nodes() noexcept
+    { return std::get<std::vector<Node>>(this->m_nodes); }
+
+    template<typename Node>
+    [[nodiscard]]
+    std::vector<Node> const& nodes() const noexcept
+    { return std::get<std::vector<Node>>(this->m_nodes); }
+
+    template<typename Node>
+    [[nodiscard]]
+    Node const& operator[](index<Node> index) const noexcept
+    { return this->nodes<Node>()[index.value]; }
+
+    template<typename Node>
+    [[nodiscard]]
+    std::span<Node const> operator[](range<Node> range) const noexcept
+    { return std::span{this->nodes<Node>()}.subspan(range.first, range.size); }
+
+    /// `name` - Returns the name of `symbol`.
+    [[nodiscard]]
+    interned name(symbol symbol) const noexcept
+    { return this->m_names.lookup(symbol); }
+
+    /// `add` - Flattens a syntax tree into the arrays and returns the index
+    /// of its root.
+    index<program> add(cebu::program const& program);
+    index<method_declaration> add(cebu::method_declaration const& method);
+    index<value_declaration> add(cebu::value_declaration const& value);
+    index<expression> add(cebu::expression const& expression);
+
+    /// `clear` - Removes every node.
+    void clear() noexcept;
+
+    /// `serialize` - Appends the names and the arrays to `out`.
+    void serialize(std::vector<std::byte>& out) const;
+
+    /// `deserialize` - Replaces the names and the arrays with those
+    /// serialized in `in`.
+    ///
+    /// Returns failure, having cleared the tree, if `in` is not a serialized
+    /// tree, including if any of its indices, ranges, kinds or symbols are
+    /// out of bounds, or any of its nodes is its own descendant.
+    result deserialize(std::span<std::byte const> in);
+
+private:
+    friend class flattener;
+    friend class validator;
+
+    cebu::interner m_names;
+    std::tuple<
+        std::vector<identifier>,
+        std::vector<type>,
+        std::vector<tuple_type>,
+        std::vector<lambda_type>,
+        std::vector<value_declaration>,
+        std::vector<method_declaration>,
+        std::vector<declaration>,
+        std::vector<body>,
+        std::vector<statement>,
+        std::vector<expression>,
+        std::vector<path>,
+        std::vector<mapping>,
+        std::vector<invocation>,
+        std::vector<cast>,
+        std::vector<operation>,
+        std::vector<assignment>,
+        std::vector<program>,
+        std::vector<std::uint64_t>,
+        std::vector<double>,
+        std::vector<range<char>>,
+        std::vector<char>
+    > m_nodes;
+};
+
+}
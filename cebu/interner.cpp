@@ -0,0 +1,44 @@
+#include <algorithm>
+
+#include "interner.h"
+
+namespace cebu
+{
+
+interned interner::intern(std::string_view string)
+{
+    auto found{this->m_symbols.find(string)};
+    if (found != this->m_symbols.end()) [[likely]]
+        return {
+            found->first.data(),
+            static_cast<std::uint32_t>(found->first.size()),
+            found->second
+        };
+
+    char* data{this->allocate(string.size())};
+    std::copy(string.begin(), string.end(), data);
+    std::string_view stored{data, string.size()};
+    auto symbol{static_cast<cebu::symbol>(this->m_strings.size())};
+    this->m_strings.push_back(stored);
+    this->m_symbols.emplace(stored, symbol);
+    return {data, static_cast<std::uint32_t>(stored.size()), symbol};
+}
+
+char* interner::allocate(std::size_t size)
+{
+    // Strings that would waste most of a block get a block of their own.
+    if (size > block_size / 4) [[unlikely]]
+        return this->m_blocks.emplace_back(new char[size]).get();
+
+    if (size > this->m_remaining) [[unlikely]] {
+        this->m_cursor = this->m_blocks.emplace_back(new char[block_size])
+                                       .get();
+        this->m_remaining = block_size;
+    }
+    char* data{this->m_cursor};
+    this->m_cursor += size;
+    this->m_remaining -= size;
+    return data;
+}
+
+}
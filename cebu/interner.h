@@ -0,0 +1,96 @@
+#pragma once
+#define CEBU_INCLUDED_INTERNER_H
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <cebu/utilities/segmented_vector.h>
+
+namespace cebu
+{
+
+/// `symbol` - The identifier of an interned string.
+///
+/// Two symbols from the same `interner` are equal if and only if their
+/// strings are equal.
+enum class symbol : std::uint32_t {};
+
+/// `interned` - An interned string paired with its symbol.
+///
+/// Comparisons only compare symbols.
+struct interned
+{
+    char const*   data{""};
+    std::uint32_t size{0};
+    cebu::symbol  symbol{};
+
+    [[nodiscard]]
+    std::string_view view() const noexcept
+    { return {data, size}; }
+
+    operator std::string_view() const noexcept
+    { return view(); }
+
+    friend constexpr bool operator==(interned const& left,
+                                     interned const& right) noexcept
+    { return left.symbol == right.symbol; }
+};
+
+/// `interner` - A table of unique strings.
+///
+/// Each distinct string is stored once in block-allocated storage, so the
+/// memory used grows with the number of distinct strings rather than the
+/// number of times they occur.  Interned strings stay valid until the
+/// interner is destroyed.
+///
+/// # Notes
+///
+/// Only one thread may intern, but the strings of the symbols that were
+/// published to other threads can be looked up from them meanwhile.
+class interner
+{
+public:
+    interner() = default;
+    interner(interner const&) = delete;
+    interner& operator=(interner const&) = delete;
+    interner(interner&&) noexcept = default;
+    interner& operator=(interner&&) noexcept = default;
+
+    /// `intern` - Returns the interned copy of `string`.
+    interned intern(std::string_view string);
+
+    /// `lookup` - Returns the string of `symbol`.
+    [[nodiscard]]
+    interned lookup(symbol symbol) const noexcept
+    {
+        std::string_view string{
+            this->m_strings[static_cast<std::uint32_t>(symbol)]
+        };
+        return {
+            string.data(),
+            static_cast<std::uint32_t>(string.size()),
+            symbol
+        };
+    }
+
+    /// `size` - Returns the number of distinct strings.
+    [[nodiscard]]
+    std::size_t size() const noexcept
+    { return this->m_strings.size(); }
+
+private:
+    static constexpr std::size_t block_size{64 * 1024};
+
+    std::unordered_map<std::string_view, symbol> m_symbols;
+    segmented_vector<std::string_view>           m_strings;
+    std::vector<std::unique_ptr<char[]>>         m_blocks;
+    char*                                        m_cursor{nullptr};
+    std::size_t                                  m_remaining{0};
+
+    char* allocate(std::size_t size);
+};
+
+}
@@ -0,0 +1,424 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+#include "json.h"
+
+namespace cebu
+{
+
+namespace
+{
+
+/// `json_parser` - A recursive descent parser of JSON text.
+class json_parser
+{
+public:
+    /// The deepest nesting of arrays and objects that is parsed, which
+    /// bounds the recursion on hostile input.
+    static constexpr int depth_limit{256};
+
+    explicit json_parser(std::string_view text) noexcept
+        : m_text{text}
+    {}
+
+    result parse(json& out)
+    {
+        if (!this->parse_value(out, 0))
+            return result::failure;
+        this->skip_whitespace();
+        return this->m_offset == this->m_text.size() ? result::success
+                                                     : result::failure;
+    }
+
+private:
+    std::string_view m_text;
+    std::size_t      m_offset{0};
+
+    [[nodiscard]]
+    char current() const noexcept
+    {
+        return this->m_offset < this->m_text.size()
+            ? this->m_text[this->m_offset] : '\0';
+    }
+
+    void skip_whitespace() noexcept
+    {
+        while (this->current() == ' ' || this->current() == '\t'
+               || this->current() == '\n' || this->current() == '\r')
+            ++this->m_offset;
+    }
+
+    bool consume(std::string_view word) noexcept
+    {
+        if (!this->m_text.substr(this->m_offset).starts_with(word))
+            return false;
+        this->m_offset += word.size();
+        return true;
+    }
+
+    result parse_value(json& out, int depth)
+    {
+        this->skip_whitespace();
+        switch (this->current()) {
+        case '{':
+            return this->parse_object(out, depth + 1);
+        case '[':
+            return this->parse_array(out, depth + 1);
+        case '"': {
+            std::string value;
+            if (!this->parse_string(value))
+                return result::failure;
+            out = std::move(value);
+            return result::success;
+        }
+        case 't':
+            out = true;
+            return this->consume("true") ? result::success : result::failure;
+        case 'f':
+            out = false;
+            return this->consume("false") ? result::success : result::failure;
+        case 'n':
+            out = nullptr;
+            return this->consume("null") ? result::success : result::failure;
+        default:
+            return this->parse_number(out);
+        }
+    }
+
+    result parse_object(json& out, int depth)
+    {
+        if (depth > depth_limit) [[unlikely]]
+            return result::failure;
+        ++this->m_offset;
+        json::object_type members;
+        this->skip_whitespace();
+        if (this->consume("}")) {
+            out = std::move(members);
+            return result::success;
+        }
+        do {
+            this->skip_whitespace();
+            std::string key;
+            if (this->current() != '"' || !this->parse_string(key))
+                return result::failure;
+            this->skip_whitespace();
+            if (!this->consume(":"))
+                return result::failure;
+            json value;
+            if (!this->parse_value(value, depth))
+                return result::failure;
+            members.emplace_back(std::move(key), std::move(value));
+            this->skip_whitespace();
+        } while (this->consume(","));
+        out = std::move(members);
+        return this->consume("}") ? result::success : result::failure;
+    }
+
+    result parse_array(json& out, int depth)
+    {
+        if (depth > depth_limit) [[unlikely]]
+            return result::failure;
+        ++this->m_offset;
+        json::array_type elements;
+        this->skip_whitespace();
+        if (this->consume("]")) {
+            out = std::move(elements);
+            return result::success;
+        }
+        do {
+            if (!this->parse_value(elements.emplace_back(), depth))
+                return result::failure;
+            this->skip_whitespace();
+        } while (this->consume(","));
+        out = std::move(elements);
+        return this->consume("]") ? result::success : result::failure;
+    }
+
+    result parse_number(json& out)
+    {
+        // `from_chars` takes no leading `+`, which JSON doesn't allow either,
+        // but takes forms that JSON doesn't, such as `inf`, so the number is
+        // checked to start like one first.
+        char const* first{this->m_text.data() + this->m_offset};
+        char const* last{this->m_text.data() + this->m_text.size()};
+        char leading{this->current() == '-' && first + 1 < last ? first[1]
+                                                                : *first};
+        if (first == last || leading < '0' || leading > '9')
+            return result::failure;
+
+        double value;
+        auto [end, error]{std::from_chars(first, last, value)};
+        if (error != std::errc{})
+            return result::failure;
+        this->m_offset += static_cast<std::size_t>(end - first);
+        out = value;
+        return result::success;
+    }
+
+    result parse_hex(std::uint32_t& out) noexcept
+    {
+        if (this->m_offset + 4 > this->m_text.size())
+            return result::failure;
+        char const* first{this->m_text.data() + this->m_offset};
+        auto [end, error]{std::from_chars(first, first + 4, out, 16)};
+        if (error != std::errc{} || end != first + 4)
+            return result::failure;
+        this->m_offset += 4;
+        return result::success;
+    }
+
+    result parse_string(std::string& out)
+    {
+        ++this->m_offset;
+        for (;;) {
+            if (this->m_offset >= this->m_text.size())
+                return result::failure;
+            char c{this->m_text[this->m_offset++]};
+            if (c == '"')
+                return result::success;
+            if (static_cast<unsigned char>(c) < 0x20)
+                return result::failure;
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+
+            switch (this->m_offset < this->m_text.size()
+                    ? this->m_text[this->m_offset++] : '\0') {
+            case '"':  out.push_back('"');  break;
+            case '\\': out.push_back('\\'); break;
+            case '/':  out.push_back('/');  break;
+            case 'b':  out.push_back('\b'); break;
+            case 'f':  out.push_back('\f'); break;
+            case 'n':  out.push_back('\n'); break;
+            case 'r':  out.push_back('\r'); break;
+            case 't':  out.push_back('\t'); break;
+            case 'u': {
+                std::uint32_t code;
+                if (!this->parse_hex(code))
+                    return result::failure;
+
+                // A high surrogate combines with the low surrogate after it.
+                // Unpaired surrogates have no UTF-8 form, so they are
+                // replaced.
+                if (code >= 0xD800 && code < 0xDC00
+                    && this->m_text.substr(this->m_offset).starts_with("\\u")) {
+                    std::size_t offset{this->m_offset};
+                    this->m_offset += 2;
+                    std::uint32_t low;
+                    if (this->parse_hex(low) && low >= 0xDC00 && low < 0xE000)
+                        code = 0x10000 + ((code - 0xD800) << 10)
+                             + (low - 0xDC00);
+                    else this->m_offset = offset;
+                }
+                if (code >= 0xD800 && code < 0xE000)
+                    code = 0xFFFD;
+                append_utf8(out, code);
+            } break;
+            default:
+                return result::failure;
+            }
+        }
+    }
+
+    static void append_utf8(std::string& out, std::uint32_t code)
+    {
+        if (code < 0x80) {
+            out.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+};
+
+/// `utf8_size` - Returns the size of the valid UTF-8 sequence at the start
+/// of `text`, or zero if it isn't one.
+std::size_t utf8_size(std::string_view text) noexcept
+{
+    auto byte{[&](std::size_t index) -> unsigned {
+        return static_cast<unsigned char>(text[index]);
+    }};
+    unsigned lead{byte(0)};
+    std::size_t size{lead < 0x80 ? 1u
+                   : lead >= 0xC2 && lead < 0xE0 ? 2
+                   : lead >= 0xE0 && lead < 0xF0 ? 3
+                   : lead >= 0xF0 && lead < 0xF5 ? 4 : 0};
+    if (size == 0 || size > text.size())
+        return 0;
+    for (std::size_t i{1}; i < size; ++i)
+        if ((byte(i) & 0xC0) != 0x80)
+            return 0;
+
+    // Overlong forms, surrogates and code points past U+10FFFF are invalid.
+    if ((lead == 0xE0 && byte(1) < 0xA0)
+        || (lead == 0xED && byte(1) >= 0xA0)
+        || (lead == 0xF0 && byte(1) < 0x90)
+        || (lead == 0xF4 && byte(1) >= 0x90))
+        return 0;
+    return size;
+}
+
+void dump_string(std::string_view value, std::string& out)
+{
+    // Strings may hold bytes of the source that aren't valid UTF-8, such as
+    // a diagnostic that quotes part of a character, which are replaced so
+    // that the output stays valid JSON.
+    auto plain{[](char c) {
+        auto byte{static_cast<unsigned char>(c)};
+        return byte >= 0x20 && byte < 0x80 && c != '"' && c != '\\';
+    }};
+    out.push_back('"');
+    for (std::size_t i{0}; i < value.size(); ++i) {
+        // Runs of characters that need no escaping are appended at once.
+        std::size_t run{i};
+        while (run < value.size() && plain(value[run]))
+            ++run;
+        out.append(value.substr(i, run - i));
+        if ((i = run) == value.size())
+            break;
+
+        char c{value[i]};
+        if (static_cast<unsigned char>(c) >= 0x80) {
+            std::size_t size{utf8_size(value.substr(i))};
+            if (size == 0)
+                out += "\ufffd";
+            else out.append(value.substr(i, size));
+            i += std::max<std::size_t>(size, 1) - 1;
+            continue;
+        }
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n";  break;
+        case '\r': out += "\\r";  break;
+        case '\t': out += "\\t";  break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                constexpr std::string_view digits{"0123456789abcdef"};
+                out += "\\u00";
+                out.push_back(digits[static_cast<unsigned char>(c) >> 4]);
+                out.push_back(digits[static_cast<unsigned char>(c) & 0xF]);
+            } else out.push_back(c);
+        }
+    }
+    out.push_back('"');
+}
+
+}
+
+result json::parse(std::string_view text, json& out)
+{ return json_parser{text}.parse(out); }
+
+void json::dump(std::string& out) const
+{
+    switch (this->type()) {
+    case null:
+        out += "null";
+        break;
+    case boolean:
+        out += std::get<bool>(this->m_value) ? "true" : "false";
+        break;
+    case number: {
+        // Integers, which are most numbers of the protocol, are printed
+        // without a fraction.
+        double value{std::get<double>(this->m_value)};
+        if (!std::isfinite(value)) {
+            out += "null";
+            break;
+        }
+        char buffer[32];
+        std::to_chars_result written{
+            value == std::trunc(value) && std::abs(value) < 0x1p53
+                ? std::to_chars(buffer, std::end(buffer),
+                                static_cast<std::int64_t>(value))
+                : std::to_chars(buffer, std::end(buffer), value)
+        };
+        out.append(buffer, written.ptr);
+    } break;
+    case string:
+        dump_string(std::get<std::string>(this->m_value), out);
+        break;
+    case array: {
+        out.push_back('[');
+        bool first{true};
+        for (json const& element : std::get<array_type>(this->m_value)) {
+            if (!std::exchange(first, false))
+                out.push_back(',');
+            element.dump(out);
+        }
+        out.push_back(']');
+    } break;
+    case object: {
+        out.push_back('{');
+        bool first{true};
+        for (auto const& [key, value] : std::get<object_type>(this->m_value)) {
+            if (!std::exchange(first, false))
+                out.push_back(',');
+            dump_string(key, out);
+            out.push_back(':');
+            value.dump(out);
+        }
+        out.push_back('}');
+    } break;
+    }
+}
+
+json const* json::find(std::string_view key) const noexcept
+{
+    auto const* members{std::get_if<object_type>(&this->m_value)};
+    if (!members)
+        return nullptr;
+    auto found{std::ranges::find(*members, key, [](auto const& member) {
+        return std::string_view{member.first};
+    })};
+    return found != members->end() ? &found->second : nullptr;
+}
+
+json const& json::operator[](std::string_view key) const noexcept
+{
+    static json const none;
+    json const* found{this->find(key)};
+    return found ? *found : none;
+}
+
+json& json::set(std::string_view key, json value) &
+{
+    if (this->type() != object)
+        this->m_value = object_type{};
+    auto& members{std::get<object_type>(this->m_value)};
+    auto found{std::ranges::find(members, key, [](auto const& member) {
+        return std::string_view{member.first};
+    })};
+    if (found != members.end())
+        found->second = std::move(value);
+    else members.emplace_back(std::string{key}, std::move(value));
+    return *this;
+}
+
+json& json::push(json value) &
+{
+    if (this->type() != array)
+        this->m_value = array_type{};
+    std::get<array_type>(this->m_value).push_back(std::move(value));
+    return *this;
+}
+
+auto json::as_array() const noexcept -> array_type const&
+{
+    static array_type const none;
+    auto const* elements{std::get_if<array_type>(&this->m_value)};
+    return elements ? *elements : none;
+}
+
+}
@@ -0,0 +1,163 @@
+#pragma once
+#define CEBU_INCLUDED_JSON_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <cebu/diagnostics.h>
+
+namespace cebu
+{
+
+/// `json` - A JSON value.
+///
+/// Objects keep their members in the order that they were added, and are
+/// searched linearly, since the messages that they are used for are small.
+///
+/// # Notes
+///
+/// Numbers are kept as doubles, so integers are exact up to 2^53.
+class json
+{
+public:
+    enum type_t
+    {
+        null,
+        boolean,
+        number,
+        string,
+        array,
+        object
+    };
+
+    using array_type = std::vector<json>;
+    using object_type = std::vector<std::pair<std::string, json>>;
+
+    json() noexcept = default;
+
+    json(std::nullptr_t) noexcept
+    {}
+
+    json(bool value) noexcept
+        : m_value{value}
+    {}
+
+    json(double value) noexcept
+        : m_value{value}
+    {}
+
+    json(int value) noexcept
+        : m_value{static_cast<double>(value)}
+    {}
+
+    json(std::size_t value) noexcept
+        : m_value{static_cast<double>(value)}
+    {}
+
+    json(std::string value) noexcept
+        : m_value{std::move(value)}
+    {}
+
+    json(std::string_view value)
+        : m_value{std::string{value}}
+    {}
+
+    json(char const* value)
+        : m_value{std::string{value}}
+    {}
+
+    json(array_type value) noexcept
+        : m_value{std::move(value)}
+    {}
+
+    json(object_type value) noexcept
+        : m_value{std::move(value)}
+    {}
+
+    /// `parse` - Parses `text` into `out`.
+    ///
+    /// Returns failure if `text` is not a single JSON value, in which case
+    /// `out` is unspecified.
+    static result parse(std::string_view text, json& out);
+
+    /// `dump` - Appends the value as compact JSON to `out`.
+    void dump(std::string& out) const;
+
+    /// `type` - Returns the type of the value.
+    [[nodiscard]]
+    type_t type() const noexcept
+    { return static_cast<type_t>(this->m_value.index()); }
+
+    /// `find` - Returns the member of an object named `key`, or null if the
+    /// value is not an object or has no such member.
+    [[nodiscard]]
+    json const* find(std::string_view key) const noexcept;
+
+    /// `operator[]` - Returns the member of an object named `key`, or a null
+    /// value if there is none.
+    [[nodiscard]]
+    json const& operator[](std::string_view key) const noexcept;
+
+    /// `set` - Makes the value an object if it isn't one and sets its member
+    /// named `key` to `value`.
+    ///
+    /// # Notes
+    ///
+    /// Calls on a temporary return it as one, so that a chain of them that
+    /// builds a message moves it into its parent instead of copying it.
+    json& set(std::string_view key, json value) &;
+
+    json&& set(std::string_view key, json value) &&
+    { return std::move(this->set(key, std::move(value))); }
+
+    /// `push` - Makes the value an array if it isn't one and appends
+    /// `value` to it.
+    json& push(json value) &;
+
+    json&& push(json value) &&
+    { return std::move(this->push(std::move(value))); }
+
+    /// `as_bool` - Returns the value if it is a boolean, otherwise false.
+    [[nodiscard]]
+    bool as_bool() const noexcept
+    {
+        auto const* value{std::get_if<bool>(&this->m_value)};
+        return value && *value;
+    }
+
+    /// `as_number` - Returns the value if it is a number, otherwise zero.
+    [[nodiscard]]
+    double as_number() const noexcept
+    {
+        auto const* value{std::get_if<double>(&this->m_value)};
+        return value ? *value : 0;
+    }
+
+    /// `as_string` - Returns the value if it is a string, otherwise an empty
+    /// string.
+    [[nodiscard]]
+    std::string_view as_string() const noexcept
+    {
+        auto const* value{std::get_if<std::string>(&this->m_value)};
+        return value ? std::string_view{*value} : std::string_view{};
+    }
+
+    /// `as_array` - Returns the elements if the value is an array, otherwise
+    /// no elements.
+    [[nodiscard]]
+    array_type const& as_array() const noexcept;
+
+private:
+    std::variant<std::monostate,
+                 bool,
+                 double,
+                 std::string,
+                 array_type,
+                 object_type> m_value;
+};
+
+}
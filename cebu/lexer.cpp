@@ -1,4 +1,4 @@
-#include <cctype>
+#include <charconv>
 #include <string>
 
 #include "lexer.h"
@@ -8,46 +8,53 @@ namespace cebu
 
 result lexer::lex(token& token) noexcept
 {
-    // Skip any whitespace.
-    while (std::isspace(current()))
-        consume();
+    skip_whitespace();
 
-    // Save the current position for diagnostics and save the state of the
-    // cursor.
-    struct position start_position{position()};
+    // Save the state of the cursor.  The offset of the token is enough to
+    // resolve its position if a diagnostic is reported.
     m_prior_cursor = m_cursor;
+    token.offset = offset();
+    token.payload = 0;
 
     // Match the current character with the start symbol of each token.
     switch (current()) {
     case '"': {
-        // Lex a string token.
+        // Lex a string token.  The value is a slice of the source unless the
+        // string contains escaped characters.
 
-        std::vector<char> buffer;
+        consume();  // Consume the initiator.
+        char const* begin{pointer()};
+        bool escaped{false};
         for (;;) {
-            consume();
-            character_result result{lex_escaped_character()};
-            if (result == character_result::failure) [[unlikely]] {
-                report<error::unknown_escaped_character>(start_position);
+            // Skip to the next terminator or escaped character.
+            skip(scan_string(pointer()));
+            if (current() == '"') [[likely]]
+                break;
+            if (current() == '\0') [[unlikely]] {
+                report<error::unterminated_string>(token.offset);
                 return result::failure;
             }
 
-            // Check if the string should be terminated.
-            if (result == character_result::regular && current() == '"') [[unlikely]]
-                break;
-            buffer.push_back(current());
+            if (lex_escaped_character() == character_result::failure)
+                [[unlikely]] {
+                report<error::unknown_escaped_character>(token.offset);
+                return result::failure;
+            }
+            escaped = true;
+            consume();
         }
+        std::string_view string{
+            begin,
+            static_cast<std::size_t>(pointer() - begin)
+        };
         consume();  // Consume the terminator.
 
         token.type = token_type::string;
-
-        // Allocate a tight space for the string then copy the string into the
-        // space.
-        token.value.string = std::string_view{
-            new char[buffer.size()],
-            buffer.size()
-        };
-        std::copy(buffer.begin(), buffer.end(),
-                  const_cast<char*>(token.value.string.begin()));
+        if (!m_literals->set_string(token, escaped ? unescape(string) : string,
+                                    !escaped)) [[unlikely]] {
+            report<error::too_many_literals>(token.offset);
+            return result::failure;
+        }
     } break;
     case '\'': {
         // Lex a character token.
@@ -55,134 +62,114 @@ result lexer::lex(token& token) noexcept
         consume();
         character_result result{lex_escaped_character()};
         if (result == character_result::failure) [[unlikely]] {
-            report<error::unknown_escaped_character>(start_position);
+            report<error::unknown_escaped_character>(token.offset);
             return result::failure;
         }
 
-        if (result == character_result::regular && current() == '\'') [[unlikely]]
-            token.value.character = '\0';
+        if (result == character_result::regular && current() == '\'')
+            [[unlikely]]
+            literal_table::set_character(token, '\0');
         else {
-            token.value.character = current();
+            literal_table::set_character(token, current());
             consume();  // Consume the value.
 
             if (current() != '\'') [[unlikely]]
-                report<error::incomplete_character>(start_position);
+                report<error::incomplete_character>(token.offset);
         }
         consume();  // Consume the terminator.
         token.type = token_type::character;
     } break;
 
-    // The following are symbolic tokens.
+    // The following are symbolic tokens that may be the start of a
+    // double-character token.
     case '=':
-        switch (peek()) {
-        case '=':
-        case '>': goto double_character;
-        }
+        if (peek() == '=')
+            token.type = token_type::double_equals_sign;
+        else if (peek() == '>')
+            token.type = token_type::rightwards_double_arrow;
+        else
+            goto single_character;
+        goto double_character;
     case '+':
-        switch (peek()) {
-        case '+': goto double_character;
-        }
+        if (peek() != '+')
+            goto single_character;
+        token.type = token_type::double_plus_sign;
+        goto double_character;
     case '-':
-        switch (peek()) {
-        case '-':
-        case '>': goto double_character;
-        }
+        if (peek() == '-')
+            token.type = token_type::double_minus_sign;
+        else if (peek() == '>')
+            token.type = token_type::rightwards_arrow;
+        else
+            goto single_character;
+        goto double_character;
     case '|':
-        switch (peek()) {
-        case '|': goto double_character;
-        }
-    case '\0':
-    case '@':
-    case ',':
+        if (peek() != '|')
+            goto single_character;
+        token.type = token_type::double_vertical_line;
+        goto double_character;
     case ':':
-    case ';':
-    case '(':
-    case ')':
-    case '[':
-    case ']':
-    case '<':
-    case '>':
-    case '*':
-    case '/':
-    case '%':
+        if (peek() != ':')
+            goto single_character;
+        token.type = token_type::double_colon;
+        goto double_character;
+    case '\0':
+        token.type = token_type::end;
+        break;
+    double_character:
+        // The type of a double-character token is set by its case since the
+        // compact token types no longer encode the characters.
+        consume();
+        consume();
+        break;
+    single_character:
         // For single-characters, we can simply cast the current character as
         // a token type since symbolic token types have the value of the
         // symbol that they represent.
         token.type = static_cast<token_type>(current());
-        goto single_character;
-    double_character:
-        // Similarly to single-characters, but we also add the peeked character
-        // and the special character `\x7f` so that the value of the token type
-        // doesn't conflict with single-character tokens.
-        token.type = static_cast<token_type>(current() + peek() + '\x7f');
-        consume();
-    single_character:
         consume();
         break;
     default:
-        // Instead of adding more cases for digits and letters, implications
-        // are used.
+        // Instead of adding more cases for the remaining symbols, digits and
+        // letters, the character class table is used.
+
+        if (is_punctuator(current()))
+            goto single_character;
 
         // Check for the start symbol of an identifier or keyword token.
-        if (std::isalpha(current()) || current() == '_') {
-            std::vector<char> buffer;
-            do {
-                buffer.push_back(current());
-                consume();
-            } while (std::isalpha(current())
-                || current() == '_'
-                || std::isdigit(current()));
-            auto view{std::string_view{buffer.data(), buffer.size()}};
+        if (is_name_start(current())) {
+            char const* begin{pointer()};
+            m_cursor.pointer = scan_name(pointer() + 1);
+            std::string_view view{
+                begin,
+                static_cast<std::size_t>(pointer() - begin)
+            };
 
             // First try to create a keyword token.  If this fails, create an
             // identifier token.
-            try {
-                token.type = get_keywords().at(view);
-            } catch (std::out_of_range const&) {
+            token.type = find_keyword(view);
+            if (token.type == token_type::none) {
                 token.type = token_type::name;
-
-                // Allocate a tight space for the identifier and copy the
-                // identifier into the space.
-                token.value.string = std::string_view{
-                    new char[buffer.size()],
-                    buffer.size()
-                };
-                std::copy(buffer.begin(), buffer.end(),
-                          const_cast<char*>(token.value.string.begin()));
+                if (!literal_table::set_name(token,
+                                             interner().intern(view)))
+                    [[unlikely]] {
+                    report<error::too_many_literals>(token.offset);
+                    return result::failure;
+                }
             }
         }
 
         // Check for the start symbol of a number token.
-        else if (std::isdigit(current())) {
-            token.type = token_type::number;
-            std::vector<char> buffer;
-            do {
-                buffer.push_back(current());
-                consume();
-                if (current() == '.') [[unlikely]] {
-                    if (token == token_type::decimal) [[unlikely]]
-                        break;
-                    token.type = token_type::decimal;
-                }
-            } while (std::isdigit(current()));
-            buffer.push_back('\0');
-
-            // Try to parse the value as the token type.
-            try {
-                if (token == token_type::decimal) [[unlikely]]
-                    token.value.decimal = std::stod(buffer.data());
-                else token.value.number = std::stoul(buffer.data());
-            } catch (std::out_of_range const&) {
-                report<error::number_overflow>(start_position, buffer);
+        else if (is_digit(current())) {
+            if (!lex_number(token)) [[unlikely]]
                 return result::failure;
-            } catch (std::invalid_argument const&) {
-                throw std::runtime_error{"unreachable"};
-            }
         }
 
-        // The character is uknown.
+        // The character is uknown.  It is consumed so that lexing can
+        // continue after the failure.
         else {
-            report<error::unknown_character>(start_position);
+            report<error::unknown_character>(token.offset);
+            consume();
             return result::failure;
         }
         break;
@@ -190,6 +177,118 @@ result lexer::lex(token& token) noexcept
     return result::success;
 }
 
+result lexer::lex_number(token& token) noexcept
+{
+    // Select the radix from the prefix.
+    unsigned radix{10};
+    if (current() == '0' && (peek() == 'x' || peek() == 'b')) [[unlikely]] {
+        radix = peek() == 'x' ? 16 : 2;
+        consume();
+        consume();
+    }
+
+    // Accumulate the digits in place.  Separators may only be between two
+    // digits.
+    char const* begin{pointer()};
+    uint128 value{0};
+    bool overflowed{false};
+    for (;; consume()) {
+        if (current() == '_') [[unlikely]] {
+            if (pointer() == begin || digit_value(peek()) >= radix)
+                return misplace_separator(token, radix);
+            continue;
+        }
+        unsigned digit{digit_value(current())};
+        if (digit >= radix)
+            break;
+        overflowed |= __builtin_mul_overflow(value, radix, &value);
+        overflowed |= __builtin_add_overflow(value, digit, &value);
+    }
+    if (pointer() == begin) [[unlikely]] {
+        report<error::missing_digits>(token.offset);
+        return result::failure;
+    }
+
+    if (radix == 10 && current() == '.') [[unlikely]] {
+        consume();
+        char const* fraction{pointer()};
+        for (;; consume()) {
+            if (current() == '_') [[unlikely]] {
+                if (pointer() == fraction || !is_digit(peek()))
+                    return misplace_separator(token, radix);
+                continue;
+            }
+            if (!is_digit(current()))
+                break;
+        }
+        if (current() == '.') [[unlikely]] {
+            report<error::multiple_decimal_points>(token.offset);
+            return result::failure;
+        }
+
+        // `std::from_chars` does not accept separators, so they are only
+        // stripped when present.
+        std::string_view digits{
+            begin,
+            static_cast<std::size_t>(pointer() - begin)
+        };
+        if (digits.find('_') != std::string_view::npos) [[unlikely]] {
+            m_buffer.clear();
+            std::ranges::copy_if(digits, std::back_inserter(m_buffer),
+                                 [](char c) { return c != '_'; });
+            digits = m_buffer;
+        }
+        double decimal;
+        auto [end, error]{std::from_chars(digits.data(),
+                                          digits.data() + digits.size(),
+                                          decimal)};
+        overflowed = error == std::errc::result_out_of_range;
+        token.type = token_type::decimal;
+        if (!overflowed && !m_literals->set_decimal(token, decimal))
+            [[unlikely]] {
+            report<error::too_many_literals>(token.offset);
+            return result::failure;
+        }
+    } else {
+        token.type = token_type::number;
+        if (!overflowed && !m_literals->set_number(token, value)) [[unlikely]] {
+            report<error::too_many_literals>(token.offset);
+            return result::failure;
+        }
+    }
+
+    if (overflowed) [[unlikely]] {
+        report<error::number_overflow>(token.offset, std::string_view{
+            m_prior_cursor.pointer,
+            static_cast<std::size_t>(pointer() - m_prior_cursor.pointer)
+        });
+        return result::failure;
+    }
+    return result::success;
+}
+
+result lexer::misplace_separator(token const& token, unsigned radix) noexcept
+{
+    // The rest of the number is consumed so that lexing continues after it
+    // rather than at a stray separator.
+    while (current() == '_' || digit_value(current()) < radix
+           || (radix == 10 && current() == '.'))
+        consume();
+    report<error::misplaced_separator>(token.offset);
+    return result::failure;
+}
+
+std::string_view lexer::unescape(std::string_view string)
+{
+    m_buffer.clear();
+    for (auto it{string.begin()}; it != string.end(); ++it) {
+        if (*it == '\\')
+            ++it;
+        m_buffer.push_back(*it);
+    }
+    return interner().intern(m_buffer).view();
+}
+
 auto lexer::lex_escaped_character() noexcept -> lexer::character_result
 {
     if (current() != '\\')
@@ -206,23 +305,35 @@ auto lexer::lex_escaped_character() noexcept -> lexer::character_result
 }
 
 template<lexer::error Error, typename ...Args>
-void lexer::report(struct position const& position, Args&&... args)
+void lexer::report(std::uint32_t offset, Args&&... args)
 {
-    struct location location{file_path(), position};
-    std::string format{std::format("[{}] lexing error: ", location)};
+    std::string format{"lexing error: "};
     if constexpr(Error == error::incomplete_character)
         format += std::format("incomplete character token");
     else if constexpr(Error == error::unknown_character)
         format += std::format("unknown character: '{}'", current());
     else if constexpr(Error == error::number_overflow)
-        format += [&](std::vector<char> const& buffer) -> std::string {
-            return std::format("number overflow: {}", buffer.data());
+        format += [&](std::string_view number) -> std::string {
+            return std::format("number overflow: {}", number);
         }(std::forward<Args>(args)...);
+    else if constexpr(Error == error::unterminated_string)
+        format += "unterminated string token";
     else if constexpr(Error == error::unknown_escaped_character)
         format += std::format("unknown escaped character: '{}'", current());
+    else if constexpr(Error == error::misplaced_separator)
+        format += "digit separator not between two digits in number token";
+    else if constexpr(Error == error::missing_digits)
+        format += "missing digits in number token";
     else if constexpr(Error == error::multiple_decimal_points)
         format += "more than one decimal point in decimal token";
-    std::cerr << format << std::endl;
+    else if constexpr(Error == error::too_many_literals)
+        format += "too many literals in source";
+    struct location location{
+        m_sources->resolve(m_sources->location(m_file, offset))
+    };
+    *m_diagnostics << std::format("[{}] {}", location, format) << std::endl;
+    if (m_sink)
+        m_sink->push_back({offset, std::move(format)});
 }
 
 }
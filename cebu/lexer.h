@@ -1,10 +1,14 @@
 #pragma once
 #define CEBU_INCLUDED_LEXER_H
 
-#include <unordered_map>
+#include <vector>
 
+#include <cebu/character.h>
 #include <cebu/token.h>
 #include <cebu/diagnostics.h>
+#include <cebu/literals.h>
+#include <cebu/scan.h>
+#include <cebu/source_manager.h>
 
 namespace cebu
 {
@@ -20,69 +24,108 @@ public:
     lexer() noexcept
     {}
 
-    /// `load` - Loads the file at `file_path` and begins the cursor at
-    /// `pointer`
-    void load(std::string_view file_path, char const* pointer) noexcept
+    /// `load` - Begins the cursor at the start of the source of `file` in
+    /// `sources`.  The values of tokens are encoded into `literals`.
+    void load(source_manager const& sources,
+              file_id               file,
+              literal_table&        literals) noexcept
     {
-        m_file_path = file_path;
-        m_cursor.pointer = pointer;
-        m_cursor.line_pointer = pointer;
-        m_cursor.line_number = 1;
+        m_sources = &sources;
+        m_file = file;
+        m_literals = &literals;
+        m_begin = sources.source(file).data();
+        m_cursor.pointer = m_begin;
+    }
+
+    /// `seek` - Moves the cursor to `offset`, which must not be inside a
+    /// token.
+    void seek(std::uint32_t offset) noexcept
+    {
+        m_cursor.pointer = m_begin + offset;
+        m_prior_cursor = m_cursor;
+    }
+
+    /// `skip_whitespace` - Moves the cursor past any whitespace, to where the
+    /// next token begins.
+    void skip_whitespace() noexcept
+    {
+        if (is_whitespace(current()))
+            skip(scan_whitespace(pointer()));
     }
 
     /// `lex` - Lexes a token into `token`.
+    ///
+    /// # Notes
+    ///
+    /// The value of `token` is encoded into the literal table.  The values
+    /// of name tokens live in the interner and stay valid after the source
+    /// is unloaded.  The values of string tokens are slices of the source,
+    /// or interned if the string contains escaped characters, so they are
+    /// only valid while the source is loaded.
     result lex(token& token) noexcept;
 
-    /// `position` - Returns the position of the cursor.
+    /// `set_diagnostics` - Prints the diagnostics to `diagnostics` instead
+    /// of the standard error.
+    void set_diagnostics(std::ostream& diagnostics) noexcept
+    { m_diagnostics = &diagnostics; }
+
+    /// `set_sink` - Also appends the diagnostics to `sink`, unless it is
+    /// null.
+    void set_sink(std::vector<diagnostic>* sink) noexcept
+    { m_sink = sink; }
+
+    /// `diagnostics` - Returns the stream that the diagnostics are printed
+    /// to.
     [[nodiscard]]
-    position position() const noexcept
-    {
-        return {
-            line_number(),
-            static_cast<std::size_t>(pointer() - line_pointer())
-        };
-    }
+    std::ostream& diagnostics() const noexcept
+    { return *m_diagnostics; }
+
+    /// `sink` - Returns the vector that the diagnostics are appended to, or
+    /// null.
+    [[nodiscard]]
+    std::vector<diagnostic>* sink() const noexcept
+    { return m_sink; }
+
+    /// `offset` - Returns the offset of the cursor from the start of the
+    /// source.
+    [[nodiscard]]
+    std::uint32_t offset() const noexcept
+    { return static_cast<std::uint32_t>(pointer() - m_begin); }
+
+    /// `literals` - Returns the table of token values.
+    [[nodiscard]]
+    literal_table& literals() const noexcept
+    { return *m_literals; }
+
+    /// `interner` - Returns the interner of names and strings.
+    [[nodiscard]]
+    cebu::interner& interner() const noexcept
+    { return m_literals->interner(); }
+
+    /// `sources` - Returns the manager of the source.
+    [[nodiscard]]
+    source_manager const& sources() const noexcept
+    { return *m_sources; }
+
+    /// `file` - Returns the file of the source.
+    [[nodiscard]]
+    file_id file() const noexcept
+    { return m_file; }
 
     /// `location` - Returns the location of the cursor.
     [[nodiscard]]
-    location location() const noexcept
-    {
-        return {
-            file_path(),
-            position()
-        };
-    }
+    source_location location() const noexcept
+    { return m_sources->location(m_file, offset()); }
 
-    /// `get_keywords` - Returns the table of string-keyword pairs.
+    /// `position` - Returns the position of the cursor.
+    ///
+    /// # Notes
+    ///
+    /// The line table is built by the first call, so this is meant for
+    /// diagnostics rather than for every token.
     [[nodiscard]]
-    static std::unordered_map<std::string_view, token_type> const&
-        get_keywords() noexcept
-    {
-        [[clang::no_destroy]]
-        static std::unordered_map<std::string_view, token_type> keywords {
-            {"b8"    , token_type::b8},
-            {"b16"   , token_type::b16},
-            {"b32"   , token_type::b32},
-            {"b64"   , token_type::b64},
-            {"i8"    , token_type::i8},
-            {"i16"   , token_type::i16},
-            {"i32"   , token_type::i32},
-            {"i64"   , token_type::i64},
-            {"f16"   , token_type::f16},
-            {"f32"   , token_type::f32},
-            {"f64"   , token_type::f64},
-            {"method", token_type::method},
-            {"trait" , token_type::trait},
-            {"type"  , token_type::type},
-            {"static", token_type::static_},
-            {"let"   , token_type::let},
-            {"if"    , token_type::if_},
-            {"else"  , token_type::else_},
-            {"elif"  , token_type::elif},
-            {"return", token_type::return_},
-        };
-        return keywords;
-    }
+    position position() const
+    { return m_sources->source(m_file).position(offset()); }
 
 private:
     enum class error
@@ -91,19 +134,27 @@ private:
        unknown_character,
        number_overflow,
        unknown_escaped_character,
-       multiple_decimal_points
+       unterminated_string,
+       multiple_decimal_points,
+       missing_digits,
+       misplaced_separator,
+       too_many_literals
     };
 
     struct cursor
     {
         char const* pointer{nullptr};
-        char const* line_pointer{pointer};
-        std::size_t line_number{1}; 
     };
 
-    std::string_view m_file_path;
-    cursor           m_prior_cursor;
-    cursor           m_cursor;
+    source_manager const*    m_sources{nullptr};
+    file_id                  m_file{file_id::none};
+    literal_table*           m_literals{nullptr};
+    std::ostream*            m_diagnostics{&std::cerr};
+    std::vector<diagnostic>* m_sink{nullptr};
+    char const*              m_begin{nullptr};
+    std::string              m_buffer;
+    cursor                   m_prior_cursor;
+    cursor                   m_cursor;
 
     enum class character_result
     {
@@ -113,31 +164,33 @@ private:
     };
 
     template<error Error, typename ...Args>
-    void report(struct position const&, Args&&...);
+    void report(std::uint32_t offset, Args&&...);
 
     character_result lex_escaped_character() noexcept;
 
+    result lex_number(token& token) noexcept;
+
+    /// `misplace_separator` - Reports a digit separator of the number token
+    /// `token` that is not between two digits, and consumes the rest of the
+    /// number.
+    result misplace_separator(token const& token, unsigned radix) noexcept;
+
+    std::string_view unescape(std::string_view string);
+
     void consume() noexcept
     {
-        if (current() == '\0') [[unlikely]]
-            return;
-        ++m_cursor.pointer;
-        if (pointer()[-1] == '\n') [[unlikely]]
-            m_cursor.line_pointer = pointer();
+        if (current() != '\0') [[likely]]
+            ++m_cursor.pointer;
     }
 
-    [[nodiscard]]
-    std::string_view const& file_path() const noexcept
-    { return m_file_path; }
+    /// `skip` - Moves the cursor forward to `end`.
+    void skip(char const* end) noexcept
+    { m_cursor.pointer = end; }
 
     [[nodiscard]]
     char const* pointer() const noexcept
     { return m_cursor.pointer; }
 
-    [[nodiscard]]
-    char const* line_pointer() const noexcept
-    { return m_cursor.line_pointer; }
-
     [[nodiscard]]
     char current() const noexcept
     { return *pointer(); }
@@ -145,10 +198,6 @@ private:
     [[nodiscard]]
     char peek() const noexcept
     { return pointer()[1]; }
-
-    [[nodiscard]]
-    std::size_t line_number() const noexcept
-    { return m_cursor.line_number; }
 };
 
 }
@@ -0,0 +1,252 @@
+#pragma once
+#define CEBU_INCLUDED_LITERALS_H
+
+#include <cebu/diagnostics.h>
+#include <cebu/interner.h>
+#include <cebu/token.h>
+#include <cebu/utilities/segmented_vector.h>
+
+namespace cebu
+{
+
+/// `literal_mark` - The sizes of the tables of a `literal_table`.
+struct literal_mark
+{
+    std::uint32_t numbers{0};
+    std::uint32_t decimals{0};
+    std::uint32_t strings{0};
+};
+
+/// `literal_table` - The values of the tokens of a source.
+///
+/// Tokens only carry a 24-bit payload, so the values that don't fit in the
+/// payload are stored here and the payload holds their index.  The table
+/// encodes the value of a token when it is lexed and decodes it on demand.
+///
+/// # Notes
+///
+/// Values never move once they are added, so a token can be decoded on one
+/// thread while the lexer adds values on another, as long as the token was
+/// published to the decoding thread after it was lexed.
+class literal_table
+{
+public:
+    literal_table() = default;
+
+    /// `load` - Clears the table and begins decoding the slices of
+    /// `source`.  Names are interned into `interner`.
+    void load(char const* source, cebu::interner& interner) noexcept
+    {
+        this->clear();
+        this->m_source = source;
+        this->m_interner = &interner;
+    }
+
+    /// `set_source` - Begins decoding the slices of `source` and keeps the
+    /// values, for a source whose tokens were moved to it with their values.
+    void set_source(char const* source) noexcept
+    { this->m_source = source; }
+
+    /// `clear` - Removes all of the values.
+    void clear() noexcept
+    {
+        this->m_numbers.clear();
+        this->m_decimals.clear();
+        this->m_strings.clear();
+    }
+
+    /// `mark` - Returns the sizes of the tables.
+    [[nodiscard]]
+    literal_mark mark() const noexcept
+    {
+        return {
+            static_cast<std::uint32_t>(this->m_numbers.size()),
+            static_cast<std::uint32_t>(this->m_decimals.size()),
+            static_cast<std::uint32_t>(this->m_strings.size())
+        };
+    }
+
+    /// `append` - Appends the values of `other` and sets `bases` to the
+    /// indices that they begin at, which the payloads of the tokens of
+    /// `other` are offset by.
+    ///
+    /// Returns failure if the tables would overflow the payloads.
+    ///
+    /// # Notes
+    ///
+    /// Strings are interned into the interner of the table, so the values
+    /// stay valid after `other` and its interner are destroyed.
+    result append(literal_table const& other, literal_mark& bases)
+    {
+        bases = this->mark();
+        if (bases.numbers + other.m_numbers.size() > token::indirect
+            || bases.decimals + other.m_decimals.size() > token::indirect
+            || bases.strings + other.m_strings.size() > token::indirect)
+            [[unlikely]]
+            return result::failure;
+        for (std::size_t i{0}; i < other.m_numbers.size(); ++i)
+            this->m_numbers.push_back(other.m_numbers[i]);
+        for (std::size_t i{0}; i < other.m_decimals.size(); ++i)
+            this->m_decimals.push_back(other.m_decimals[i]);
+        for (std::size_t i{0}; i < other.m_strings.size(); ++i)
+            this->m_strings.push_back(
+                this->m_interner->intern(other.m_strings[i]).view());
+        return result::success;
+    }
+
+    /// `interner` - Returns the interner of names.
+    [[nodiscard]]
+    cebu::interner& interner() const noexcept
+    { return *this->m_interner; }
+
+    //
+    // Encoding
+    //
+    // Each function returns failure if the value does not fit in a payload
+    // and the table is full.
+    //
+
+    /// `set_name` - Sets the value of the name token `token` to `name`.
+    static result set_name(token& token, interned name) noexcept
+    {
+        auto symbol{static_cast<std::uint32_t>(name.symbol)};
+        if (symbol > token::max_payload) [[unlikely]]
+            return result::failure;
+        token.payload = symbol;
+        return result::success;
+    }
+
+    /// `set_number` - Sets the value of the number token `token`.
+    result set_number(token& token, uint128 number)
+    {
+        if (number < token::indirect) [[likely]] {
+            token.payload = static_cast<std::uint32_t>(number);
+            return result::success;
+        }
+        return push(token, this->m_numbers, number);
+    }
+
+    /// `set_decimal` - Sets the value of the decimal token `token`.
+    result set_decimal(token& token, double decimal)
+    { return push(token, this->m_decimals, decimal); }
+
+    /// `set_string` - Sets the value of the string token `token` to
+    /// `string`, which is a slice of the source if `sliced`.
+    result set_string(token& token, std::string_view string, bool sliced)
+    {
+        if (sliced && string.size() < token::indirect) [[likely]] {
+            token.payload = static_cast<std::uint32_t>(string.size());
+            return result::success;
+        }
+        return push(token, this->m_strings, string);
+    }
+
+    /// `set_character` - Sets the value of the character token `token`.
+    static void set_character(token& token, char character) noexcept
+    { token.payload = static_cast<unsigned char>(character); }
+
+    //
+    // Decoding
+    //
+
+    /// `name` - Returns the value of the name token `token`.
+    [[nodiscard]]
+    interned name(token const& token) const noexcept
+    { return this->m_interner->lookup(static_cast<symbol>(token.payload)); }
+
+    /// `number` - Returns the value of the number token `token`.
+    [[nodiscard]]
+    uint128 number(token const& token) const noexcept
+    {
+        if (token.payload & token::indirect) [[unlikely]]
+            return this->m_numbers[token.payload & ~token::indirect];
+        return token.payload;
+    }
+
+    /// `decimal` - Returns the value of the decimal token `token`.
+    [[nodiscard]]
+    double decimal(token const& token) const noexcept
+    { return this->m_decimals[token.payload & ~token::indirect]; }
+
+    /// `string` - Returns the value of the string token `token`.
+    ///
+    /// # Notes
+    ///
+    /// Slices are only valid while the source is loaded.
+    [[nodiscard]]
+    std::string_view string(token const& token) const noexcept
+    {
+        if (token.payload & token::indirect) [[unlikely]]
+            return this->m_strings[token.payload & ~token::indirect];
+        return {this->m_source + token.offset + 1, token.payload};
+    }
+
+    /// `character` - Returns the value of the character token `token`.
+    [[nodiscard]]
+    static char character(token const& token) noexcept
+    { return static_cast<char>(token.payload); }
+
+private:
+    char const*                        m_source{""};
+    cebu::interner*                    m_interner{nullptr};
+    segmented_vector<uint128>          m_numbers;
+    segmented_vector<double>           m_decimals;
+    segmented_vector<std::string_view> m_strings;
+
+    template<typename T>
+    static result push(token&              token,
+                       segmented_vector<T>& values,
+                       T const&             value)
+    {
+        auto index{static_cast<std::uint32_t>(values.size())};
+        if (index >= token::indirect) [[unlikely]]
+            return result::failure;
+        values.push_back(value);
+        token.payload = token::indirect | index;
+        return result::success;
+    }
+};
+
+/// `valued_token` - A token paired with the table of its value so that it
+/// can be formatted with its value.
+struct valued_token
+{
+    cebu::token                token;
+    cebu::literal_table const& literals;
+};
+
+}
+
+template<>
+struct std::formatter<cebu::valued_token>
+    : formatter<string>
+{
+    auto format(cebu::valued_token const& self, format_context& ctx) const
+    {
+        auto const& [token, literals]{self};
+        string format{std::format("{}", token)};
+        if (token.is_valuable()) {
+            format += "\n\tvalue: ";
+            switch (token.type) {
+            case cebu::token_type::string:
+                format += std::format("\"{}\"", literals.string(token));
+                break;
+            case cebu::token_type::name:
+                format += std::format("{}", literals.name(token).view());
+                break;
+            case cebu::token_type::character:
+                format += std::format("'{}'", literals.character(token));
+                break;
+            case cebu::token_type::number:
+                format += cebu::to_string(literals.number(token));
+                break;
+            case cebu::token_type::decimal:
+                format += std::format("{}", literals.decimal(token));
+                break;
+            default:
+                break;
+            }
+        }
+        return formatter<string>::format(format, ctx);
+    }
+};
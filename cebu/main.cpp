@@ -1,17 +1,121 @@
-#include <cebu/parser.h>
-#include <cebu/lexer.h> 
-#include <cebu/syntax.h>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <vector>
+
+#include <cebu/driver.h>
+#include <cebu/server.h>
+
+/// The front end.
+///
+/// # Usage
+///
+/// cebu [-j threads] [--lexing=mode] file...
+/// cebu --lsp
+///
+/// Parses every file, on one thread per core unless `-j` is given, then
+/// prints the diagnostics of the files in the order that they were given,
+/// the statistics of the arenas of the syntax trees, and the time that
+/// parsing took.
+///
+/// `--lexing` chooses how each file is lexed:
+///
+/// - `streamed`: As the parser needs the tokens, which is the default.
+/// - `batch`: Into a token buffer before the file is parsed.
+/// - `parallel`: Into a token buffer in chunks of lines on the threads
+///   that the files are parsed on.
+/// - `pipeline`: On a thread of its own while the file is parsed.  The time
+///   that overlapping lexing and parsing saved is printed with the time.
+///
+/// Any other argument that starts with `-` is rejected with the usage.
+///
+/// With `--lsp`, runs as a language server over the standard input and
+/// output until the client exits, keeping the files that the client opens
+/// parsed between requests.
 
 using namespace cebu;
 
 int main(int argc, char** argv)
 {
-    (void)argc, (void)argv;
-
-    parser parser;
-    parser.load("/home/king/cebu/test3");
-    do {
-        parser.consume();
-        std::cout << std::format("{}", parser.token()) << std::endl;
-    } while (parser.token() != token_type::end);
+    if (argc == 2 && std::string_view{argv[1]} == "--lsp") {
+        // The streams carry only the protocol, so they needn't be kept in
+        // step with C's.
+        std::ios::sync_with_stdio(false);
+        return server{}.run(std::cin, std::cout);
+    }
+
+    constexpr std::string_view usage{
+        "usage: cebu [-j threads] [--lexing=mode] file...\n"
+        "       cebu --lsp"
+    };
+    constexpr std::string_view lexing_flag{"--lexing="};
+    constexpr std::string_view lexing_modes[]{
+        "streamed", "batch", "parallel", "pipeline"
+    };
+
+    unsigned threads{0};
+    std::string_view lexing{lexing_modes[0]};
+    std::vector<std::string_view> file_paths;
+    for (int i{1}; i < argc; ++i) {
+        std::string_view argument{argv[i]};
+        if (argument.starts_with(lexing_flag)) {
+            lexing = argument.substr(lexing_flag.size());
+            if (std::ranges::find(lexing_modes, lexing)
+                == std::end(lexing_modes)) {
+                std::cerr << std::format("invalid lexing mode: '{}'", lexing)
+                          << std::endl;
+                return 2;
+            }
+            continue;
+        }
+        if (!argument.starts_with('-')) {
+            file_paths.push_back(argument);
+            continue;
+        }
+        if (!argument.starts_with("-j")) {
+            std::cerr << std::format("unknown option: '{}'\n{}", argument,
+                                     usage) << std::endl;
+            return 2;
+        }
+
+        // The count may be attached, as in `-j8`, or the next argument.
+        std::string_view count{argument.substr(2)};
+        if (count.empty() && i + 1 < argc)
+            count = argv[++i];
+        auto [end, error]{std::from_chars(count.data(),
+                                          count.data() + count.size(),
+                                          threads)};
+        if (error != std::errc{} || end != count.data() + count.size()) {
+            std::cerr << std::format("invalid thread count: '{}'", count)
+                      << std::endl;
+            return 2;
+        }
+    }
+    if (file_paths.empty()) {
+        std::cerr << usage << std::endl;
+        return 2;
+    }
+
+    driver driver{threads};
+    result result{result::failure};
+    if (lexing == "batch")
+        result = driver.parse<map_option, batch_option>(file_paths);
+    else if (lexing == "parallel")
+        result = driver.parse<map_option, batch_option, parallel_option>(
+            file_paths);
+    else if (lexing == "pipeline")
+        result = driver.parse<map_option, pipeline_option>(file_paths);
+    else result = driver.parse<map_option>(file_paths);
+    driver.print_diagnostics(std::cerr);
+    std::cerr << std::format("arena: {}", driver.arena_statistics())
+              << std::endl;
+
+    using seconds = std::chrono::duration<double>;
+    std::string time{std::format(
+        "time: {:.3f} s", seconds{driver.time()}.count())};
+    if (lexing == "pipeline")
+        time += std::format(", {:.3f} s saved by overlapping lexing",
+                            seconds{driver.overlap()}.count());
+    std::cerr << time << std::endl;
+    return result ? 0 : 1;
 }
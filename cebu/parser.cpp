@@ -1,5 +1,11 @@
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+#include <cebu/token_ring.h>
 
 #include "cebu/syntax.h"
 #include "cebu/token.h"
@@ -8,137 +14,386 @@
 namespace cebu
 {
 
-char const* end_of_file_error::what() const noexcept
-{ return "end of file"; }
-
-template<parsing_error Error, typename ...Args>
-void parser::report(Args&&... args) const noexcept
-{
-    std::string format{std::format("[{}] parsing error: ", this->location())};
-    if constexpr(Error == parsing_error::unexpected_token) {
-        [&](auto const& tokens) {
-            if constexpr(requires {
-                typename decltype(tokens)::value_type;
-            }) {
-                format += "expected one of tokens:\n";
-                for (cebu::token const& t : tokens)
-                    format += std::format("\t`{}`\n", t);
-            } else format += std::format("expected token `{}``",
-                                         tokens, token());
-        }(args...);
-        format += std::format("intead of token `{}`", this->token());
+/// `parser::pipeline` - The lexer of a parser running on a thread of its
+/// own, which passes the tokens to the parser through a ring.
+///
+/// The lexer's diagnostics are queued before the token that reported them
+/// is pushed, and the parser moves them into its held back diagnostics when
+/// it pops a token after them, so they are printed in order with the
+/// parser's as in the other modes.
+struct parser::pipeline
+{
+    token_ring               ring;
+    cebu::token              end;
+    bool                     ended{false};
+
+    /// The time that the lexer spent lexing rather than waiting for space,
+    /// which is set before the thread ends.
+    std::chrono::nanoseconds lexing{0};
+
+    /// The diagnostics of the token that the lexer is lexing, which only the
+    /// lexer's thread touches until it is joined.
+    std::vector<diagnostic>  lexed;
+
+    /// The diagnostics that were queued for the parser, and whether there
+    /// are any, which the parser checks without locking for every token.
+    std::mutex               mutex;
+    std::vector<diagnostic>  queued;
+    std::atomic<bool>        pending{false};
+
+    /// `send` - Queues the diagnostics that were lexed.
+    void send()
+    {
+        std::scoped_lock lock{this->mutex};
+        std::ranges::move(this->lexed, std::back_inserter(this->queued));
+        this->lexed.clear();
+        this->pending.store(true, std::memory_order_relaxed);
     }
-    std::cerr << format << std::endl;
+
+    /// `receive` - Moves the diagnostics that were queued to `out`.
+    void receive(std::vector<diagnostic>& out)
+    {
+        std::scoped_lock lock{this->mutex};
+        std::ranges::move(this->queued, std::back_inserter(out));
+        this->queued.clear();
+        this->pending.store(false, std::memory_order_relaxed);
+    }
+
+    /// Declared last so that it is joined before the rest is destroyed.
+    std::jthread             thread;
+
+    ~pipeline()
+    { this->ring.close(); }
+};
+
+parser::parser()
+{
+    this->m_lexer.set_diagnostics(this->m_discard);
+    this->m_lexer.set_sink(&this->m_lexing);
 }
 
-parser& parser::unsafely_load_file(std::string_view const& file_path)
+parser::~parser()
+{ this->stop_pipeline(); }
+
+parser& parser::unsafely_load_file(std::string_view const& file_path,
+                                   source_backend          backend)
 {
-    std::ifstream file{file_path.begin()};
-    std::ostringstream sstr;
-    sstr << file.rdbuf();
-    m_source = sstr.str();
-    m_lexer.load(file_path, m_source.data());
+    this->m_file = this->m_sources->load(file_path, backend);
+    if (this->m_file == file_id::none) [[unlikely]] {
+        *this->m_diagnostics << std::format(
+            "[{}] loading error: could not load file", file_path) << std::endl;
+        if (this->m_sink)
+            this->m_sink->push_back({0, "loading error: could not load file"});
+        this->set_failed();
+
+        // Lex an empty source under the path so diagnostics still name it.
+        this->m_file = this->m_sources->assign(file_path, {});
+    }
+    this->begin_file(this->m_file);
     return *this;
 }
 
-template<typename ...Ts>
-void syntax_parser<method_declaration, Ts...>::
-    parse(parser&             parser,
-          method_declaration& out)
-{
-    parser
-        .parse<identifier, on_failure_option>(out.identifier)
-        .parse<lambda_type>(out.lambda)
-        .parse<body>(out.body);
-}
-
-template<typename ...Ts>
-void syntax_parser<lambda_type, Ts...>::
-    parse(parser&      parser,
-          lambda_type& out)
-{
-    parser
-        .parse<tuple_type>(out.tuple)
-        .expect<token_type::rightwards_arrow>()
-        .parse<type>(out.return_type);
-}
-
-template<typename ...Ts>
-void syntax_parser<tuple_type, Ts...>::
-    parse(parser& parser, tuple_type& out)
-{
-    bool proceed{false};
-    parser
-        .expect<token_type::left_parenthesis, on_success_option>([&] {
-            do {
-                out.mappings.resize(out.mappings.size() + 1);
-                parser
-                    .parse<value_declaration>(out.mappings.back())
-                    .expect<std::array{
-                        token_type::comma,
-                        token_type::right_parenthesis
-                    }, on_success_option, on_failure_option>([&] {
-                        proceed = parser.token() != token_type::right_parenthesis;
-                    }, [&] { proceed = false; });
-            } while (proceed);
-        });
-}
-
-template<typename ...Ts>
-void syntax_parser<type, Ts...>::
-    parse(parser& parser, type& out)
-{
-    parser
-        .expect<std::array{
-            token_type::b8,
-            token_type::b16,
-            token_type::b32,
-            token_type::b64,
-            token_type::i8,
-            token_type::i16,
-            token_type::i32,
-            token_type::i64,
-            token_type::f16,
-            token_type::f32,
-            token_type::f64,
-            token_type::left_parenthesis
-        }, on_success_option>([&] {
-            if (parser.token() == token_type::left_parenthesis) {
-                out.type = type::tuple;
-                tuple_type* tuple{new tuple_type};
-                parser
-                    .parse<tuple_type>(*tuple)
-                    .expect<
-                        token_type::rightwards_arrow,
-                        on_success_option, on_failure_option,
-                        dont_report_option
-                    >([&] {
-                        out.type = type::lambda;
-                        out.value.lambda = new lambda_type;
-                        out.value.lambda->tuple.mappings = std::move(tuple->mappings);
-                        delete tuple;
-                        parser
-                            .parse<type>(out.value.lambda->return_type);
-                    }, [&] {
-                        out.type = type::tuple;
-                    });
-            } else {
-                out.type = type::primitive;
-                out.value.primitive = static_cast<primitive_type>(
-                    parser.token().type);
-            }
-        });
-}
-
-template<typename ...Ts>
-void syntax_parser<value_declaration, Ts...>::
-    parse(parser& parser, value_declaration& out)
-{
-    parser
-        .parse<identifier>(out.identifier)
-        .expect<token_type::colon>()
-        .parse<type>(out.type)
-        .parse<body>(out.body);
+void parser::begin_file(file_id file)
+{
+    this->m_file = file;
+    this->m_literals.load(this->source().data(), this->m_interner);
+    this->m_lexer.load(*this->m_sources, this->m_file, this->m_literals);
+}
+
+void parser::lex_all(thread_pool* pool)
+{
+    if (pool)
+        this->m_tokens.lex(this->m_lexer, *pool);
+    else this->m_tokens.lex(this->m_lexer, this->source().size());
+    this->m_flags.batched = true;
+}
+
+thread_pool& parser::lexing_pool()
+{
+    if (!this->m_lexing_pool) [[unlikely]]
+        this->m_lexing_pool = std::make_unique<thread_pool>(
+            this->m_lexing_threads);
+    return *this->m_lexing_pool;
+}
+
+result parser::edit(std::uint32_t    offset,
+                    std::uint32_t    removed,
+                    std::string_view inserted,
+                    cebu::splice&    splice)
+{
+    if (!this->m_flags.batched
+        || !this->m_sources->edit(this->m_file, offset, removed, inserted))
+        [[unlikely]]
+        return result::failure;
+
+    // The tokens keep their values, but the source may have moved.
+    this->m_literals.set_source(this->source().data());
+    this->m_lexer.load(*this->m_sources, this->m_file, this->m_literals);
+    this->m_lexer.set_sink(nullptr);
+    (void)this->m_tokens.relex(this->m_lexer, offset, removed,
+                               static_cast<std::uint32_t>(inserted.size()),
+                               splice);
+    this->m_lexer.set_sink(&this->m_lexing);
+    this->m_errors = 0;
+    this->seek(0);
+    return result::success;
+}
+
+void parser::find_lexing_errors(std::size_t               first,
+                                std::size_t               last,
+                                std::vector<std::size_t>& indices) const
+{
+    // Characters report a missing terminator but still lex.
+    auto reports{[](token_type type) noexcept {
+        return (type == token_type::none) | (type == token_type::character);
+    }};
+
+    // Such tokens are rare, so whole blocks of tokens are tested without
+    // branches, which vectorizes, and only the blocks that have one are
+    // walked.
+    constexpr std::size_t block{64};
+    token_type const* types{this->m_tokens.types().data()};
+    while (first < last) {
+        std::size_t end{std::min(first + block, last)};
+        bool any{false};
+        if (end - first == block) [[likely]] {
+            unsigned char hits{0};
+            for (std::size_t i{0}; i < block; ++i)
+                hits |= reports(types[first + i]);
+            any = hits;
+        } else any = true;
+        if (any) [[unlikely]]
+            for (std::size_t i{first}; i < end; ++i)
+                if (reports(types[i]))
+                    indices.push_back(i);
+        first = end;
+    }
+}
+
+void parser::report_lexing_errors(std::span<std::size_t const> indices)
+{
+    cebu::token token;
+    for (std::size_t index : indices) {
+        this->m_lexer.seek(this->m_tokens.offset(index));
+        (void)this->m_lexer.lex(token);
+    }
+}
+
+void parser::start_pipeline()
+{
+    this->m_pipeline = std::make_unique<pipeline>();
+    this->m_lexer.set_sink(&this->m_pipeline->lexed);
+
+    // Both threads resolve positions with the line table, which can only be
+    // shared between threads once it is built.
+    (void)this->source().lines().size();
+
+    // The pipeline is captured rather than read through `m_pipeline`, which
+    // the parser's thread resets once the thread is joined.
+    this->m_pipeline->thread = std::jthread{[this,
+                                             &pipeline = *this->m_pipeline] {
+        // The lexer only lexes and the parser only decodes, and the literal
+        // table and interner never move their values, so they are shared
+        // without locks.
+        auto start{std::chrono::steady_clock::now()};
+        cebu::token token;
+        do {
+            if (!this->m_lexer.lex(token)) [[unlikely]]
+                token.type = token_type::none;
+
+            // The diagnostics are queued before the token is pushed, so the
+            // parser has them once it pops the token.
+            if (!pipeline.lexed.empty()) [[unlikely]]
+                pipeline.send();
+            if (!pipeline.ring.push(token)) [[unlikely]]
+                return;
+        } while (token != token_type::end);
+        pipeline.lexing = std::chrono::steady_clock::now() - start
+                        - pipeline.ring.producer_waited();
+        pipeline.ring.publish();
+    }};
+}
+
+void parser::stop_pipeline() noexcept
+{
+    if (!this->m_pipeline)
+        return;
+
+    // The diagnostics of the tokens that the lexer lexed ahead of the parser
+    // are kept, to be printed after the ones that were received.
+    pipeline& pipeline{*this->m_pipeline};
+    pipeline.ring.close();
+    if (pipeline.thread.joinable())
+        pipeline.thread.join();
+    pipeline.receive(this->m_lexing);
+    std::ranges::move(pipeline.lexed, std::back_inserter(this->m_lexing));
+    this->m_pipeline.reset();
+    this->m_lexer.set_sink(&this->m_lexing);
+}
+
+result parser::pull(cebu::token& token) noexcept
+{
+    if (!this->m_pipeline) [[likely]]
+        return this->m_lexer.lex(token);
+
+    pipeline& pipeline{*this->m_pipeline};
+    if (pipeline.ended) [[unlikely]] {
+        token = pipeline.end;
+        return result::success;
+    }
+    token = pipeline.ring.pop();
+    if (pipeline.pending.load(std::memory_order_relaxed)) [[unlikely]]
+        pipeline.receive(this->m_lexing);
+    if (token == token_type::end) [[unlikely]] {
+        pipeline.thread.join();
+        pipeline.ended = true;
+        pipeline.end = token;
+
+        // Lexing that the parser didn't wait for overlapped parsing.
+        this->m_overlap = std::max(
+            pipeline.lexing - pipeline.ring.consumer_waited(),
+            std::chrono::nanoseconds{0});
+    }
+    return token == token_type::none ? result::failure : result::success;
+}
+
+result parser::advance() noexcept
+{
+    if (this->m_flags.batched) {
+        this->m_token = this->m_tokens.at(this->m_index);
+        if (this->m_index + 1 < this->m_tokens.size())
+            ++this->m_index;
+    } else {
+        if (!this->m_lookahead.empty()) {
+            this->m_token = this->m_lookahead.front();
+            this->m_lookahead.pop_front();
+        } else if (!this->pull(this->m_token)) [[unlikely]]
+            this->m_token.type = token_type::none;
+        if (this->speculating()) [[unlikely]]
+            this->m_replay.push_back(this->m_token);
+    }
+    return this->m_token == token_type::none ? result::failure
+                                              : result::success;
+}
+
+parser& parser::rewind(parser_checkpoint const& checkpoint)
+{
+    if (this->m_flags.batched)
+        this->m_index = checkpoint.index;
+    else {
+        this->m_lookahead.insert(this->m_lookahead.begin(),
+                                 this->m_replay.begin() + checkpoint.index,
+                                 this->m_replay.end());
+        this->m_replay.resize(checkpoint.index);
+    }
+    this->m_token = checkpoint.token;
+    this->m_errors = checkpoint.errors;
+    this->m_deferred.resize(checkpoint.diagnostics);
+    this->m_arena.rewind(checkpoint.arena);
+    this->m_scope_depth = checkpoint.scope_depth;
+    this->m_flags = checkpoint.flags;
+    return this->commit();
+}
+
+parser& parser::commit()
+{
+    if (--this->m_speculations > 0)
+        return *this;
+    for (diagnostic& diagnostic : this->m_deferred)
+        this->emit(std::move(diagnostic));
+    this->m_deferred.clear();
+    this->m_replay.clear();
+    return *this;
+}
+
+parser& parser::flush_diagnostics()
+{
+    this->flush_lexing(std::numeric_limits<std::uint32_t>::max());
+    return *this;
+}
+
+void parser::emit(diagnostic&& diagnostic)
+{
+    if (this->speculating()) [[unlikely]] {
+        this->m_deferred.push_back(std::move(diagnostic));
+        return;
+    }
+    this->flush_lexing(diagnostic.offset);
+    this->print(std::move(diagnostic));
+}
+
+void parser::print(diagnostic&& diagnostic)
+{
+    *this->m_diagnostics << std::format(
+        "[{}] {}",
+        this->m_sources->resolve(this->m_sources->location(this->m_file,
+                                                         diagnostic.offset)),
+        diagnostic.message) << std::endl;
+    if (this->m_sink)
+        this->m_sink->push_back(std::move(diagnostic));
+}
+
+void parser::flush_lexing(std::uint32_t through)
+{
+    // The lexer reports in the order of the source, so the ones up to
+    // `through` are at the front.
+    std::size_t& next{this->m_lexing_next};
+    while (next < this->m_lexing.size()
+           && this->m_lexing[next].offset <= through)
+        this->print(std::move(this->m_lexing[next++]));
+    if (next == this->m_lexing.size()) {
+        this->m_lexing.clear();
+        next = 0;
+    }
+}
+
+parser& parser::recover()
+{
+    // Brackets that are opened while skipping must be closed before a `;`
+    // can end the syntax or a `}` can close an enclosing body.
+    static constexpr token_set openers{
+        token_type::left_parenthesis,
+        token_type::left_square_bracket,
+        token_type::left_curly_bracket
+    };
+    static constexpr token_set closers{
+        token_type::right_parenthesis,
+        token_type::right_square_bracket,
+        token_type::right_curly_bracket
+    };
+
+    int depth{0};
+    for (;;) {
+        cebu::token token{this->lookahead()};
+        if (token == token_type::end || token == determiner_tokens
+            || (depth == 0 && token == token_type::right_curly_bracket))
+            break;
+        this->consume();
+        if (token == openers)
+            ++depth;
+        else if (token == closers && depth > 0)
+            --depth;
+        else if (depth == 0 && token == token_type::semicolon)
+            break;
+    }
+    return this->unset_failed();
+}
+
+token parser::lookahead(std::size_t distance)
+{
+    if (this->m_flags.batched)
+        return this->m_tokens.at(std::min(this->m_index + distance - 1,
+                                          this->m_tokens.size() - 1));
+
+    while (this->m_lookahead.size() < distance) {
+        if (!this->m_lookahead.empty()
+            && this->m_lookahead.back() == token_type::end)
+            return this->m_lookahead.back();
+        cebu::token& token{this->m_lookahead.emplace_back()};
+        if (!this->pull(token)) [[unlikely]]
+            token.type = token_type::none;
+    }
+    return this->m_lookahead[distance - 1];
 }
 
 }
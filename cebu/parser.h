@@ -1,15 +1,22 @@
 #pragma once
 #define CEBU_INCLUDED_PARSER_H
 
-#include <fcntl.h>
-#include <sys/mman.h>
-#include <sys/stat.h>
 #include <type_traits>
-#include <unistd.h>
 
+#include <chrono>
 #include <concepts>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <vector>
 
+#include <cebu/arena.h>
 #include <cebu/lexer.h>
+#include <cebu/literals.h>
+#include <cebu/source_manager.h>
+#include <cebu/token_buffer.h>
 #include <cebu/syntax.h>
 #include <cebu/utilities/type_traits.h>
 
@@ -26,20 +33,10 @@ struct ignore_failure_option {};
 struct on_failure_option {};
 struct on_success_option {};
 struct dont_report_option {};
-
-class end_of_file_error 
-    : public std::out_of_range
-{
-public:
-    using base_type = std::out_of_range;
-
-    end_of_file_error() noexcept
-        : base_type{"end of file"}
-    {}
-
-    [[nodiscard]]
-    char const* what() const noexcept override;
-};
+struct map_option {};
+struct batch_option {};
+struct pipeline_option {};
+struct parallel_option {};
 
 class parser;
 
@@ -54,31 +51,146 @@ concept parsable =
 
 enum class parsing_error
 {
-    unexpected_token
+    unexpected_token,
+    unexpected_end,
+    too_deep,
+    number_overflow
 };
 
 struct parser_flags
 {
     unsigned char
-        failed   : 1 = false,
-        padding : 7;
+        failed       : 1 = false,
+        too_deep     : 1 = false,
+        batched      : 1 = false,
+        copy_strings : 1 = false,
+        padding      : 4;
 };
 
-inline void do_nothing() {}
+/// `parser_checkpoint` - A position of a `parser` that it can be rewound
+/// to.
+struct parser_checkpoint
+{
+    /// The current token.
+    cebu::token  token{};
+
+    /// The index of the next token in the token buffer, or the number of
+    /// tokens that were consumed while speculating.
+    std::size_t  index{0};
+
+    std::size_t  errors{0};
+
+    /// The number of diagnostics that were deferred while speculating.
+    std::size_t  diagnostics{0};
+
+    arena_mark   arena;
+    int          scope_depth{0};
+    parser_flags flags;
+};
+
+/// `nothing` - A callback that does nothing.
+struct nothing
+{
+    constexpr void operator()() const noexcept {}
+};
+
+/// `do_nothing` - The default callback of the parser's combinators.
+inline constexpr nothing do_nothing;
+
+/// `expression_frame` - A level of nesting of the expression parser.
+///
+/// Each frame stands for an operand and the operators that follow it, with
+/// the expression parsed so far as its `value`.  A frame that needs a nested
+/// expression sets where the nested expression goes and which step it
+/// resumes at, then pushes a frame for it.
+struct expression_frame
+{
+    enum class step : std::uint8_t
+    {
+        operand,
+        operators,
+        right_parenthesis,
+        comma,
+        separator
+    };
+
+    expression  value{};
+
+    /// Where the expression of the frame above goes, or null if it is an
+    /// argument of the invocation that is the `value`.
+    expression* hole{nullptr};
 
+    /// The name of the argument that is being parsed.
+    identifier  name{};
+
+    /// The size of the scratch stack of mappings before the arguments.
+    std::size_t base{0};
+
+    int         precedence{0};
+    step        next{step::operand};
+};
+
+/// `type_frame` - A level of nesting of the type parser.
+///
+/// Each frame stands for a type that is written to `out`.  A tuple type
+/// parses its mappings and a lambda type its return type in frames of their
+/// own.
+///
+/// The mappings of a tuple are pushed onto the scratch stack of value
+/// declarations while they are parsed, which moves them as it grows, so the
+/// frame of a mapping's type locates the mapping by its index instead.
+struct type_frame
+{
+    enum class step : std::uint8_t
+    {
+        type,
+        tuple,
+        mapping,
+        separator,
+        arrow
+    };
+
+    cebu::type*        out{nullptr};
+    cebu::lambda_type* lambda{nullptr};
+    cebu::tuple_type*  tuple{nullptr};
+
+    /// The index of the mapping whose type goes here if `out` is null.
+    std::size_t        mapping{0};
+
+    /// The size of the scratch stack of value declarations before the
+    /// mappings of `tuple`.
+    std::size_t        base{0};
+
+    step               next{step::type};
+};
+
+/// `parser` - A parser built from combinators.
+///
+/// # Notes
+///
+/// Callbacks are template parameters rather than `std::function`s, so a
+/// chain of combinators inlines into the calling `syntax_parser` without
+/// allocating or type-erasing its lambdas.
+///
+/// Once the "failed" flag is set, `parse` and `expect` do nothing until the
+/// failure is resolved or `recover`ed, so a chain stops at its first error
+/// instead of reporting the errors that follow from it.
 class parser
 {
 public:
-    parser() = default;
-    ~parser() = default;
+    parser();
+    ~parser();
 
     /// `parse` - Parses a `Syntax`.
-    template<parsable Syntax, typename ...Opts>
+    template<parsable Syntax, typename ...Opts,
+             typename OnSuccess = nothing, typename OnFailure = nothing>
     parser& parse(Syntax& out,
-                        std::function<void()> on_success = do_nothing,
-                        std::function<void()> on_failure = do_nothing)
+                  OnSuccess&& on_success = {},
+                  OnFailure&& on_failure = {})
         noexcept(find_type_v<nothrow_option, Opts...>)
     {
+        if (this->failed()) [[unlikely]]
+            return *this;
         syntax_parser<Syntax, Opts...>::parse(*this, out);
         if (this->failed()) [[unlikely]] {
             if constexpr(find_type_v<on_failure_option, Opts...>) {
@@ -93,24 +205,30 @@ public:
     }
 
     /// `consume` - Consumes the current token.
-    /// 
+    ///
     /// # Notes
     ///
-    /// If the `peek` was previously invoked, the options are ignored.
-    template<typename ...Opts>
-    parser& consume(std::function<void()> on_success = do_nothing,
-                          std::function<void()> on_failure   = do_nothing)
+    /// The end is consumed once.  Consuming past it fails like a token that
+    /// can't be lexed, with the end reported as unexpected, and the parser
+    /// stays at the end.  No exception is thrown, so a parse that runs into
+    /// the end unwinds through the "failed" flag like any other failure.
+    template<typename ...Opts,
+             typename OnSuccess = nothing, typename OnFailure = nothing>
+    parser& consume(OnSuccess&& on_success = {},
+                    OnFailure&& on_failure = {})
         noexcept(find_type_v<nothrow_option, Opts...>)
     {
-        if (this->token() == token_type::end) [[unlikely]] {
-            if constexpr(find_type_v<nothrow_option, Opts...>)
-                return *this;
-            throw end_of_file_error{};
-        }
-        if (this->m_lexer.lex(m_token)) [[unlikely]] {
+        bool ended{this->token() == token_type::end};
+        if (!ended && this->advance()) [[likely]] {
             if constexpr(find_type_v<on_success_option, Opts...>)
                 on_success();
-        } else if constexpr(find_type_v<on_failure_option, Opts...>) {
+            return *this;
+        }
+
+        if constexpr(!find_type_v<dont_report_option, Opts...>)
+            if (ended)
+                this->report<parsing_error::unexpected_end>(this->token());
+        if constexpr(find_type_v<on_failure_option, Opts...>) {
             if constexpr(find_type_v<on_success_option, Opts...>)
                 resolve_failure(on_failure);
             else resolve_failure(on_success);
@@ -119,19 +237,32 @@ public:
         return *this;
     }
 
-    /// `expect` - Consumes and, if the consumed token is not equavalent to
-    /// `Token`, the "failure" flag is set.
-    template<auto Token, typename ...Opts>
-    parser& expect(std::function<void()> on_success = do_nothing,
-                         std::function<void()> on_failure = do_nothing)
+    /// `expect` - Consumes the next token if it is equivalent to `Token`.
+    /// Otherwise, the "failure" flag is set and the token is left for
+    /// `recover`.
+    ///
+    /// A token that couldn't be lexed is counted as an error but not
+    /// reported again, since the lexer reported it.
+    template<auto Token, typename ...Opts,
+             typename OnSuccess = nothing, typename OnFailure = nothing>
+    parser& expect(OnSuccess&& on_success = {},
+                   OnFailure&& on_failure = {})
     {
-        this->consume<Opts...>();
-        if (this->token() == Token) [[likely]] {
+        if (this->failed()) [[unlikely]]
+            return *this;
+        cebu::token next{this->lookahead()};
+        if (next == Token) [[likely]] {
+            this->consume<Opts...>();
             if constexpr(find_type_v<on_success_option, Opts...>)
                 on_success();
         } else {
-            if constexpr(!find_type_v<dont_report_option, Opts...>)
-                this->report<parsing_error::unexpected_token>(Token);
+            // A token that couldn't be lexed was reported by the lexer, so
+            // it is only counted.
+            if constexpr(!find_type_v<dont_report_option, Opts...>) {
+                if (next != token_type::none) [[likely]]
+                    this->report<parsing_error::unexpected_token>(next, Token);
+                else ++this->m_errors;
+            }
             if constexpr(find_type_v<on_failure_option, Opts...>)
                 this->resolve_failure(on_failure);
             else if constexpr(!find_type_v<ignore_failure_option, Opts...>)
@@ -141,39 +272,271 @@ public:
     }
 
     /// `peek` - Gives the current token then consumes the current token.
-    template<typename ...Opts>
-    parser& peek(token&          token,
-                       std::function<void()> on_success = do_nothing,
-                       std::function<void()> on_failure = do_nothing)
+    template<typename ...Opts,
+             typename OnSuccess = nothing, typename OnFailure = nothing>
+    parser& peek(cebu::token& token,
+                 OnSuccess&&  on_success = {},
+                 OnFailure&&  on_failure = {})
         noexcept(find_type_v<nothrow_option, Opts...>)
     {
         token = this->token();
-        return this->consume<Opts...>(on_success, on_failure);
+        return this->consume<Opts...>(std::forward<OnSuccess>(on_success),
+                                      std::forward<OnFailure>(on_failure));
     }
 
     /// `then` - Invokes `fn`.
-    parser& then(std::function<void()> fn)
+    template<typename Fn>
+    parser& then(Fn&& fn)
     {
         fn();
         return *this;
     }
 
     /// `resolve_failure` - Invokes `fn` and unsets the "failed" flags.
-    parser& resolve_failure(std::function<void()> fn)
+    template<typename Fn>
+    parser& resolve_failure(Fn&& fn)
     {
         fn();
         this->unset_failed();
         return *this;
     }
 
+    /// `lookahead` - Returns the token `distance` tokens after the current
+    /// token without consuming any tokens.
+    ///
+    /// # Notes
+    ///
+    /// When the source was loaded with `batch_option`, this is an index into
+    /// the token buffer.  Otherwise, the tokens are lexed once and queued for
+    /// `consume`.
+    [[nodiscard]]
+    cebu::token lookahead(std::size_t distance = 1);
+
     /// `load` - Unloads then loads the file at `file_path`.
+    ///
+    /// # Options
+    ///
+    /// - `map_option`: Maps the file into memory instead of reading it into
+    ///   a buffer.
+    /// - `batch_option`: Lexes the whole file into a token buffer up front,
+    ///   which the parser then walks by index.
+    /// - `parallel_option`: With `batch_option`, lexes large files in chunks
+    ///   of lines on the threads of a pool of the parser's own, which
+    ///   `set_lexing_threads` sizes.
+    /// - `pipeline_option`: Lexes the file on a thread of its own while it is
+    ///   parsed, so that lexing and parsing overlap.  The lexer's diagnostics
+    ///   are passed to the parser with the tokens, so they are printed in the
+    ///   same order as when the tokens are lexed on the parser's thread.
+    template<typename ...Opts>
     parser& load(std::string_view const& file_path)
-    { return this->unload().unsafely_load_file(file_path); }
+    {
+        this->unload().unsafely_load_file(
+            file_path,
+            find_type_v<map_option, Opts...> ? source_backend::mapped
+                                             : source_backend::buffered);
+        this->begin_lexing<Opts...>();
+        return *this;
+    }
+
+    /// `assign` - Unloads then loads `contents` as the source of a file at
+    /// `file_path` that is not read from the disk.
+    ///
+    /// # Options
+    ///
+    /// - `batch_option`, `parallel_option`, `pipeline_option`: Same as for
+    ///   `load`.
+    ///
+    /// # Notes
+    ///
+    /// Every source takes its size of the 32-bit source space.  The parser's
+    /// own manager reuses the space of the source it unloads, but a manager
+    /// given to `set_sources` keeps every source that is assigned to it, so
+    /// a parser that shares one fills it eventually.
+    template<typename ...Opts>
+    parser& assign(std::string_view file_path, std::string contents)
+    {
+        this->unload().begin_file(
+            this->m_sources->assign(file_path, std::move(contents)));
+        this->begin_lexing<Opts...>();
+        return *this;
+    }
+
+    /// `load` - Unloads then lexes `file`, which was already added to the
+    /// manager given to `set_sources`.
+    ///
+    /// # Options
+    ///
+    /// - `batch_option`, `parallel_option`, `pipeline_option`: Same as for
+    ///   loading a file path.
+    template<typename ...Opts>
+    parser& load(file_id file)
+    {
+        this->unload().begin_file(file);
+        this->begin_lexing<Opts...>();
+        return *this;
+    }
+
+    /// `load` - Same as loading `file`, but with `parallel_option` the
+    /// chunks are lexed on the threads of `pool` rather than of the parser's
+    /// own pool, so that the threads of many parsers are bounded together.
+    ///
+    /// # Notes
+    ///
+    /// `pool` can't run the chunks while it runs another batch, so this must
+    /// not be called from its tasks.
+    template<typename ...Opts>
+    parser& load(file_id file, thread_pool& pool)
+    {
+        this->unload().begin_file(file);
+        this->begin_lexing<Opts...>(&pool);
+        return *this;
+    }
+
+    /// `edit` - Replaces the `removed` characters at `offset` of the source
+    /// with `inserted`, lexes again the tokens that the edit damaged, and
+    /// sets `splice` to the tokens that were replaced.
+    ///
+    /// The source is edited in place, so the locations before the edit stay
+    /// valid, and the locations after it move by the change in size.  The
+    /// parser is moved before the first token and its errors are counted
+    /// anew.
+    ///
+    /// Returns failure, having changed nothing, if the source was not loaded
+    /// with `batch_option`, the edit is out of the source, or the edited
+    /// source doesn't fit in the source space.
+    ///
+    /// # Notes
+    ///
+    /// Strings of syntax trees that slice the source are invalidated, so
+    /// trees that are kept across edits must be parsed with
+    /// `set_copy_strings`.
+    ///
+    /// The new tokens are lexed without printing diagnostics, since they
+    /// would be out of order with the diagnostics of the old tokens.
+    /// `report_lexing_errors` prints the diagnostics of any tokens that
+    /// `find_lexing_errors` finds.
+    result edit(std::uint32_t    offset,
+                std::uint32_t    removed,
+                std::string_view inserted,
+                cebu::splice&    splice);
+
+    /// `seek` - Moves the parser so that the token at `index` of the token
+    /// buffer is next, as if the tokens before it were just consumed, and
+    /// unsets the "failed" flag.  The source must have been loaded with
+    /// `batch_option`.
+    parser& seek(std::size_t index) noexcept
+    {
+        this->m_index = index;
+        this->m_token = index ? this->m_tokens.at(index - 1) : cebu::token{};
+        this->m_scope_depth = 0;
+        return this->unset_failed();
+    }
+
+    /// `index` - Returns the index of the next token in the token buffer.
+    [[nodiscard]]
+    std::size_t index() const noexcept
+    { return this->m_index; }
+
+    /// `tokens` - Returns the token buffer, which is only filled when the
+    /// source was loaded with `batch_option`.
+    [[nodiscard]]
+    token_buffer const& tokens() const noexcept
+    { return this->m_tokens; }
+
+    /// `find_lexing_errors` - Appends to `indices` the indices of the tokens
+    /// from `first` to `last` of the token buffer that may have reported a
+    /// lexing error, which are those that failed and characters.
+    void find_lexing_errors(std::size_t               first,
+                            std::size_t               last,
+                            std::vector<std::size_t>& indices) const;
+
+    /// `report_lexing_errors` - Reports the diagnostics of the tokens at
+    /// `indices` of the token buffer by lexing them again.
+    void report_lexing_errors(std::span<std::size_t const> indices);
 
     /// `unload` - Unloads the source.
+    ///
+    /// # Notes
+    ///
+    /// The syntax trees parsed from the source are freed with the arena.  A
+    /// source of a manager given to `set_sources` stays in it so that
+    /// locations into it stay valid.  A source of the parser's own manager is
+    /// only located by the freed trees, so it is released and its range of
+    /// the source space is reused by the next source.
     parser& unload()
     {
-        this->m_source.resize(0);
+        this->stop_pipeline();
+        this->flush_diagnostics();
+        this->m_arena.release();
+        if (this->m_sources == &this->m_own_sources)
+            this->m_own_sources.release(this->m_file);
+        std::apply([](auto&... stacks) { (stacks.clear(), ...); },
+                   this->m_scratch);
+        this->begin_file(file_id::none);
+        this->m_tokens.clear();
+        this->m_lookahead.clear();
+        this->m_replay.clear();
+        this->m_deferred.clear();
+        this->m_speculations = 0;
+        this->m_index = 0;
+        this->m_scope_depth = 0;
+        this->m_errors = 0;
+        this->m_overlap = {};
+        this->m_flags.batched = false;
+        return *this;
+    }
+
+    /// `overlap` - Returns the time that lexing overlapped parsing, which is
+    /// the time that pipeline mode saved over lexing then parsing on one
+    /// thread.
+    ///
+    /// It is zero until the parser reaches the end of a source that was
+    /// loaded with `pipeline_option`.
+    [[nodiscard]]
+    std::chrono::nanoseconds overlap() const noexcept
+    { return this->m_overlap; }
+
+    /// `set_diagnostics` - Prints the diagnostics of the parser and its
+    /// lexer to `diagnostics` instead of the standard error.
+    parser& set_diagnostics(std::ostream& diagnostics) noexcept
+    {
+        this->m_diagnostics = &diagnostics;
+        return *this;
+    }
+
+    /// `set_sink` - Also appends the diagnostics of the parser and its lexer
+    /// to `sink`, unless it is null, in the order that they are printed.
+    parser& set_sink(std::vector<diagnostic>* sink) noexcept
+    {
+        this->m_sink = sink;
+        return *this;
+    }
+
+    /// `flush_diagnostics` - Prints the lexer's diagnostics that are held
+    /// back.
+    ///
+    /// The lexer's diagnostics are held back until the parser reports a
+    /// diagnostic at or after their offsets, and printed before it, so the
+    /// diagnostics are in the order of the source whether the tokens were
+    /// lexed up front, as the parser needed them or on the lexer's thread.
+    /// The ones after the last of the parser's are printed by this, which
+    /// `unload` and parsing a `program` call.
+    parser& flush_diagnostics();
+
+    /// `set_sources` - Unloads, then adds the sources that are loaded to
+    /// `sources` instead of to a manager of the parser's own, so that the
+    /// locations of the parsers that share it are comparable.
+    ///
+    /// # Notes
+    ///
+    /// Parsers only read the manager while they parse, so parsers that share
+    /// one may parse on different threads, as long as none of them loads,
+    /// assigns or edits a source meanwhile.
+    parser& set_sources(source_manager& sources)
+    {
+        this->unload();
+        this->m_sources = &sources;
+        this->begin_file(file_id::none);
         return *this;
     }
 
@@ -182,6 +545,135 @@ public:
     bool failed() const noexcept
     { return m_flags.failed; }
 
+    /// `recover` - Skips the rest of the syntax that failed and unsets the
+    /// "failed" flag so that parsing can resume.
+    ///
+    /// Tokens are skipped until a `;` that ends the syntax is consumed, or
+    /// until a `}` that closes an enclosing body, a declaration keyword or the
+    /// end is next.  Brackets that are opened while skipping are skipped with
+    /// their contents.  Tokens that couldn't be lexed are skipped without
+    /// being reported again.
+    parser& recover();
+
+    /// `errors` - Returns the number of errors reported since the source was
+    /// loaded.
+    [[nodiscard]]
+    std::size_t errors() const noexcept
+    { return this->m_errors; }
+
+    /// `checkpoint` - Begins speculating and returns the position of the
+    /// parser, which `rewind` returns to.
+    ///
+    /// Every checkpoint must be either `rewind`ed to or `commit`ted, in the
+    /// reverse order that they were taken.
+    ///
+    /// # Notes
+    ///
+    /// While speculating, the tokens that are consumed are kept so that a
+    /// rewind puts them back in front of the lookahead instead of lexing them
+    /// again, and diagnostics are deferred rather than printed.  Nothing is
+    /// kept in batch mode, where a rewind only resets the index into the
+    /// token buffer.
+    [[nodiscard]]
+    parser_checkpoint checkpoint() noexcept
+    {
+        ++this->m_speculations;
+        return {
+            this->m_token,
+            this->m_flags.batched ? this->m_index : this->m_replay.size(),
+            this->m_errors,
+            this->m_deferred.size(),
+            this->m_arena.mark(),
+            this->m_scope_depth,
+            this->m_flags
+        };
+    }
+
+    /// `rewind` - Returns to `checkpoint` and ends its speculation.
+    ///
+    /// The tokens that were consumed, the nodes that were made and the errors
+    /// that were reported since `checkpoint` are undone.
+    parser& rewind(parser_checkpoint const& checkpoint);
+
+    /// `commit` - Ends the speculation of the last checkpoint and keeps what
+    /// was parsed since it.
+    ///
+    /// The deferred diagnostics are printed once every speculation has ended.
+    parser& commit();
+
+    /// `speculating` - Returns whether a checkpoint is neither rewound to nor
+    /// committed.
+    [[nodiscard]]
+    bool speculating() const noexcept
+    { return this->m_speculations > 0; }
+
+    /// `enter_scope` - Enters a nested syntax that counts as `scopes` levels
+    /// of nesting.
+    ///
+    /// Returns failure, and reports an error and sets the "failed" flag, if
+    /// the nesting would exceed the depth limit.
+    result enter_scope(int scopes = 1) noexcept
+    {
+        if (this->m_scope_depth > this->m_depth_limit - scopes) [[unlikely]] {
+            this->report<parsing_error::too_deep>(this->lookahead());
+            this->m_flags.too_deep = true;
+            this->set_failed();
+            return result::failure;
+        }
+        this->m_scope_depth += scopes;
+        return result::success;
+    }
+
+    /// `exit_scope` - Exits `scopes` nested syntaxes.
+    void exit_scope(int scopes = 1) noexcept
+    { this->m_scope_depth -= scopes; }
+
+
+    /// `set_depth_limit` - Sets the deepest nesting that is parsed.
+    ///
+    /// # Notes
+    ///
+    /// Nested expressions and types are parsed with explicit stacks rather
+    /// than by recursion, so the limit bounds the memory of the stacks rather
+    /// than protecting the call stack.  Declarations in bodies are parsed by
+    /// recursion, and each counts as `syntax_parser<body>::declaration_scopes`
+    /// levels, so the limit bounds the call stack too.
+    parser& set_depth_limit(int limit) noexcept
+    {
+        this->m_depth_limit = limit;
+        return *this;
+    }
+
+    /// `set_lexing_threads` - Sets the number of threads of the parser's own
+    /// pool, which lexes with `parallel_option` when no pool is given, or
+    /// one per core if `threads` is zero, which is the default.
+    parser& set_lexing_threads(unsigned threads)
+    {
+        this->m_lexing_threads = threads;
+        this->m_lexing_pool.reset();
+        return *this;
+    }
+
+    /// `set_copy_strings` - Sets whether the values of string literals are
+    /// copied into the arena rather than sliced from the source, so that
+    /// they outlive edits of the source.
+    parser& set_copy_strings(bool copy) noexcept
+    {
+        this->m_flags.copy_strings = copy;
+        return *this;
+    }
+
+    /// `copies_strings` - Returns whether the values of string literals are
+    /// copied into the arena.
+    [[nodiscard]]
+    bool copies_strings() const noexcept
+    { return this->m_flags.copy_strings; }
+
+    /// `depth_limit` - Returns the deepest nesting that is parsed.
+    [[nodiscard]]
+    int depth_limit() const noexcept
+    { return this->m_depth_limit; }
+
     /// `get_failed` - Same as `parser::failed` but returns to `failed`.
     parser& get_failed(bool& failed) noexcept
     {
@@ -200,41 +692,235 @@ public:
     parser& unset_failed() noexcept
     {
         this->m_flags.failed = false;
+        this->m_flags.too_deep = false;
         return *this;
     }
 
-    /// `location` - Returns the location of the cursor.
-    location location() const noexcept
-    { return this->m_lexer.location(); }
+    /// `too_deep` - Returns whether the "failed" flag was set because the
+    /// nesting exceeded the depth limit.
+    [[nodiscard]]
+    bool too_deep() const noexcept
+    { return this->m_flags.too_deep; }
+
+    /// `location` - Returns the location of the current token.
+    [[nodiscard]]
+    source_location location() const noexcept
+    { return this->m_sources->location(this->m_file, this->m_token.offset); }
 
     /// `token` - Returns the current token.
     [[nodiscard]]
     token const& token() const noexcept
     { return this->m_token; }
 
-    /// `source` - Returns the contents of the source.
+    /// `source` - Returns the source.
+    [[nodiscard]]
+    cebu::source const& source() const noexcept
+    { return this->m_sources->source(this->m_file); }
+
+    /// `sources` - Returns the manager of the loaded sources, which decodes
+    /// locations.
+    [[nodiscard]]
+    source_manager const& sources() const noexcept
+    { return *this->m_sources; }
+
+    /// `file` - Returns the file of the source.
     [[nodiscard]]
-    std::string const& source() const noexcept
-    { return this->m_source; }
+    file_id file() const noexcept
+    { return this->m_file; }
+
+    /// `interner` - Returns the table of interned names and strings.
+    [[nodiscard]]
+    cebu::interner const& interner() const noexcept
+    { return this->m_interner; }
+
+    /// `arena` - Returns the arena that the syntax trees of the source are
+    /// allocated from.
+    [[nodiscard]]
+    cebu::arena& arena() noexcept
+    { return this->m_arena; }
+
+    [[nodiscard]]
+    cebu::arena const& arena() const noexcept
+    { return this->m_arena; }
+
+    /// `scratch` - Returns the scratch stack of `T`s.
+    ///
+    /// # Notes
+    ///
+    /// The elements of a list are pushed here while the list is parsed, then
+    /// `collect`ed into the arena.  Nested lists push above the elements of
+    /// the lists that contain them.  The stacks keep their capacity, so lists
+    /// are built without allocating once the stacks have grown.
+    template<typename T>
+    [[nodiscard]]
+    std::vector<T>& scratch() noexcept
+    { return std::get<std::vector<T>>(this->m_scratch); }
+
+    /// `collect` - Copies the `T`s of the scratch stack from `base` up into
+    /// the arena, pops them, and returns the copy.
+    template<typename T>
+    std::span<T> collect(std::size_t base)
+    {
+        std::vector<T>& stack{this->scratch<T>()};
+        std::span<T> values{
+            this->m_arena.copy(std::span<T const>{stack}.subspan(base))
+        };
+        stack.resize(base);
+        return values;
+    }
+
+    /// `literals` - Returns the values of the tokens.
+    [[nodiscard]]
+    literal_table const& literals() const noexcept
+    { return this->m_literals; }
 
     /// `file_path` - Returns the source's file path.
     [[nodiscard]]
-    std::string_view const& file_path() const noexcept
-    { return this->m_lexer.file_path(); }
+    std::string_view file_path() const noexcept
+    { return this->source().file_path(); }
+
+private:
+    template<typename T, typename ...Ts>
+    friend struct syntax_parser;
+
+    static constexpr int default_depth_limit{1 << 16};
+
+    source_manager          m_own_sources;
+    source_manager*         m_sources{&this->m_own_sources};
+    file_id                 m_file{file_id::none};
+    cebu::interner          m_interner;
+    literal_table           m_literals;
+    cebu::arena             m_arena;
+    std::tuple<
+        std::vector<identifier>,
+        std::vector<mapping>,
+        std::vector<expression_frame>,
+        std::vector<type_frame>,
+        std::vector<statement>,
+        std::vector<value_declaration>
+    >                       m_scratch;
+    lexer                   m_lexer;
+    token_buffer            m_tokens;
+    std::size_t             m_index{0};
+    std::deque<cebu::token> m_lookahead;
+    cebu::token             m_token;
+    parser_flags            m_flags;
+    int                     m_scope_depth{0};
+    int                     m_depth_limit{default_depth_limit};
+    std::size_t             m_errors{0};
+    std::ostream*           m_diagnostics{&std::cerr};
+    int                     m_speculations{0};
+
+    /// The vector that the diagnostics are also appended to, if any.
+    std::vector<diagnostic>* m_sink{nullptr};
 
-private:       
-    std::string  m_source;
-    lexer        m_lexer;
-    cebu::token  m_token;
-    parser_flags m_flags;
-    int          m_scope_depth{0};
+    /// The pool that lexes with `parallel_option` when no pool is given,
+    /// which is made when it is first needed, and the size to make it.
+    std::unique_ptr<thread_pool> m_lexing_pool;
+    unsigned                m_lexing_threads{0};
 
+    /// The time that lexing overlapped parsing in pipeline mode.
+    std::chrono::nanoseconds m_overlap{0};
+
+    /// The tokens that were consumed while speculating.
+    std::vector<cebu::token> m_replay;
+
+    /// The diagnostics that were reported while speculating.
+    std::vector<diagnostic> m_deferred;
+
+    /// The lexer's diagnostics, which are held back to be printed in order
+    /// with the parser's, and the index of the first that wasn't printed.
+    std::vector<diagnostic> m_lexing;
+    std::size_t             m_lexing_next{0};
+
+    /// The stream that the lexer prints to, which discards its diagnostics
+    /// since the parser prints them from `m_lexing`.
+    std::ostream            m_discard{nullptr};
+
+    struct pipeline;
+
+    /// The lexer's thread in pipeline mode.  It is declared last so that it
+    /// is stopped before the rest of the parser is destroyed.
+    std::unique_ptr<pipeline> m_pipeline;
+
+    /// `report` - Reports `Error` at the token `at`.
     template<parsing_error Error, typename ...Args>
-    void report(Args&&... args) const noexcept;
+    void report(cebu::token const& at, Args&&... args) noexcept;
+
+    /// `emit` - Prints `diagnostic` after the lexer's diagnostics before
+    /// it, or defers it while speculating.
+    void emit(diagnostic&& diagnostic);
+
+    /// `print` - Prints `diagnostic` and appends it to the sink.
+    void print(diagnostic&& diagnostic);
+
+    /// `flush_lexing` - Prints the lexer's diagnostics that are held back up
+    /// to the offset `through`.
+    void flush_lexing(std::uint32_t through);
+
+    parser& unsafely_load_file(std::string_view const& file_path,
+                               source_backend          backend);
 
-    parser& unsafely_load_file(std::string_view const& file_path);
+    void begin_file(file_id file);
+
+    template<typename ...Opts>
+    void begin_lexing(thread_pool* pool = nullptr)
+    {
+        if constexpr(find_type_v<batch_option, Opts...>) {
+            if constexpr(find_type_v<parallel_option, Opts...>)
+                this->lex_all(pool ? pool : &this->lexing_pool());
+            else this->lex_all(nullptr);
+        } else if constexpr(find_type_v<pipeline_option, Opts...>)
+            this->start_pipeline();
+    }
+
+    /// `lex_all` - Lexes the source into the token buffer, in chunks on the
+    /// threads of `pool` unless it is null.
+    void lex_all(thread_pool* pool);
+
+    /// `lexing_pool` - Returns the parser's own pool, making it if it wasn't.
+    thread_pool& lexing_pool();
+
+    void start_pipeline();
+
+    void stop_pipeline() noexcept;
+
+    /// `pull` - Lexes the next token, or takes it from the lexer's thread in
+    /// pipeline mode.
+    result pull(cebu::token& token) noexcept;
+
+    result advance() noexcept;
 };
 
+template<parsing_error Error, typename ...Args>
+void parser::report(cebu::token const& at, Args&&... args) noexcept
+{
+    ++this->m_errors;
+    std::string format{"parsing error: "};
+    if constexpr(Error == parsing_error::unexpected_token) {
+        [&](auto const& tokens) {
+            if constexpr(std::same_as<decltype(tokens), token_set const&>) {
+                format += "expected one of tokens:\n";
+                for (std::size_t t{0}; t < token_set::capacity; ++t)
+                    if (tokens.contains(static_cast<token_type>(t)))
+                        format += std::format("\t`{}`\n",
+                                              static_cast<token_type>(t));
+            } else format += std::format("expected token `{}` ", tokens);
+        }(args...);
+        format += std::format("intead of token `{}`", at);
+    } else if constexpr(Error == parsing_error::unexpected_end)
+        format += "unexpected end of file";
+    else if constexpr(Error == parsing_error::too_deep)
+        format += std::format("nesting exceeds the depth limit of {}",
+                              this->m_depth_limit);
+    else if constexpr(Error == parsing_error::number_overflow)
+        format += std::format("number overflow: {} exceeds the largest "
+                              "integer, {}",
+                              to_string(this->m_literals.number(at)),
+                              std::numeric_limits<std::int64_t>::max());
+    this->emit({at.offset, std::move(format)});
+}
+
 //
 // Parsers
 //
@@ -245,16 +931,44 @@ struct syntax_parser<identifier, Ts...>
     static void parse(parser& parser, identifier& out);
 };
 
+/// `syntax_parser<body>` - A parser of bodies.
+///
+/// A statement that begins with a name and a colon or a parenthesis may be
+/// an expression, as a cast or an invocation, or a declaration, which only
+/// the tokens after the type or the tuple tell apart.  The likelier of the
+/// two is tried first, and the other is tried after rewinding if it fails.
 template<typename ...Ts>
 struct syntax_parser<body, Ts...>
 {
+    /// The levels of nesting that a declaration in a body counts as, since
+    /// it is parsed by recursion, which takes far more of the call stack than
+    /// a frame of the expression and type parsers takes of their stacks.
+    static constexpr int declaration_scopes{256};
+
     static void parse(parser& parser, body& out);
+
+    /// `parse_statement` - Parses a statement of a body into `out`.
+    static void parse_statement(parser& parser, statement& out);
+
+    /// `parse_expression` - Parses an expression statement into `out`.
+    static void parse_expression(parser& parser, statement& out);
+
+    /// `parse_declaration` - Parses a declaration statement into `out`.
+    static void parse_declaration(parser& parser, statement& out);
 };
 
+/// `syntax_parser<type>` - A parser of types.
+///
+/// Tuple and lambda types nest, so they are parsed with an explicit stack of
+/// `type_frame`s rather than by recursion.
 template<typename ...Ts>
 struct syntax_parser<type, Ts...>
 {
-    static void parse(parser&, type&);
+    static void parse(parser& parser, type& out)
+    { run(parser, {.out = &out}); }
+
+    /// `run` - Parses the type of `root` and the types nested in it.
+    static void run(parser& parser, type_frame root);
 };
 
 template<typename ...Ts>
@@ -266,7 +980,13 @@ struct syntax_parser<value_declaration, Ts...>
 template<typename ...Ts>
 struct syntax_parser<tuple_type, Ts...>
 {
-    static void parse(parser& parser, tuple_type& out);
+    static void parse(parser& parser, tuple_type& out)
+    {
+        syntax_parser<type, Ts...>::run(parser, {
+            .tuple = &out,
+            .next = type_frame::step::tuple
+        });
+    }
 };
 
 template<typename ...Ts>
@@ -281,4 +1001,696 @@ struct syntax_parser<method_declaration, Ts...>
     static void parse(parser& parser, method_declaration& out);
 };
 
+template<typename ...Ts>
+struct syntax_parser<declaration, Ts...>
+{
+    static void parse(parser& parser, declaration& out);
+};
+
+/// `syntax_parser<program>` - A parser of every declaration of a source.
+///
+/// A declaration that fails is dropped and parsing resumes at the next one,
+/// so every error of the source is reported in one pass.  The "failed" flag
+/// is set at the end if any error was reported.
+template<typename ...Ts>
+struct syntax_parser<program, Ts...>
+{
+    static void parse(parser& parser, program& out);
+
+    /// `parse_next` - Parses the next declaration into `out`, or skips the
+    /// syntax of one that fails.  Returns whether a declaration was added.
+    static bool parse_next(parser& parser, program& out);
+};
+
+/// `syntax_parser<expression>` - A precedence climbing parser of
+/// expressions.
+///
+/// An operand is parsed, then each following operator whose precedence is at
+/// most the allowed precedence takes the expression so far as its left
+/// operand.  The right operand of a left-associative operator only allows
+/// operators that bind tighter, so `a - b - c` is `(a - b) - c` and the
+/// expression is parsed in a single pass without backtracking.  Nodes are
+/// made in the arena and lists are built on the scratch stacks.
+///
+/// Operands nest, so each is parsed in an `expression_frame` of an explicit
+/// stack rather than by recursion.
+template<typename ...Ts>
+struct syntax_parser<expression, Ts...>
+{
+    using frame = expression_frame;
+    using step = expression_frame::step;
+
+    /// `first` - The tokens that begin an expression.
+    static constexpr token_set first{
+        token_type::number,
+        token_type::decimal,
+        token_type::character,
+        token_type::string,
+        token_type::name,
+        token_type::left_parenthesis
+    };
+
+    static void parse(parser& parser, expression& out)
+    { parse(parser, out, implication::precedence); }
+
+    /// `parse` - Parses an expression whose operators have a precedence of
+    /// at most `precedence`.
+    static void parse(parser& parser, expression& out, int precedence);
+
+    /// `parse_operand` - Parses the operand of the top frame.
+    static void parse_operand(parser& parser, std::vector<frame>& frames);
+
+    /// `parse_operator` - Parses the operator after the value of the top
+    /// frame.  Returns false if none follows.
+    static bool parse_operator(parser& parser, std::vector<frame>& frames);
+
+    /// `parse_path` - Parses the rest of the path whose first name is the
+    /// current token.
+    static void parse_path(parser& parser, path& out);
+
+    /// `begin_argument` - Parses the name of the next argument of the
+    /// invocation of the top frame, if it is named, and pushes a frame for
+    /// its value.
+    static void begin_argument(parser& parser, std::vector<frame>& frames);
+
+    /// `parse_cast_argument` - Speculatively parses a cast of a name that is
+    /// the whole next argument and pushes it onto the arguments.  Returns
+    /// false, having parsed nothing, if the argument is not one.
+    static bool parse_cast_argument(parser& parser);
+
+    /// `push` - Pushes a frame for an expression whose operators have a
+    /// precedence of at most `precedence`.
+    static void push(parser& parser, std::vector<frame>& frames,
+                     int precedence)
+    {
+        if (parser.enter_scope())
+            frames.push_back({.precedence = precedence});
+    }
+
+    /// `push_binary` - Parses the operator of a binary `Operation` whose left
+    /// operand is the value of the top frame and pushes a frame for its right
+    /// operand.
+    template<typename Operation>
+    static void push_binary(parser& parser, std::vector<frame>& frames,
+                            expression::type_t type);
+
+    /// `make` - Makes a `Node` in the arena as the value of `out`.
+    template<typename Node>
+    static Node* make(parser& parser, expression& out,
+                      expression::type_t type)
+    {
+        Node* node{parser.arena().make<Node>()};
+        out.type = type;
+        static_cast<Node*&>(out) = node;
+        return node;
+    }
+};
+
+template<typename ...Ts>
+void syntax_parser<identifier, Ts...>::
+    parse(parser& parser, identifier& out)
+{
+    parser
+        .expect<token_type::name, on_success_option>([&] {
+            out.name = parser.literals().name(parser.token());
+            out.location = parser.location();
+        });
+}
+
+template<typename ...Ts>
+void syntax_parser<body, Ts...>::
+    parse(parser& parser, body& out)
+{
+    // The statements are pushed onto the scratch stack, then collected into
+    // the arena once the body is closed.
+    std::size_t base{parser.scratch<statement>().size()};
+    auto push{[&](cebu::statement const& statement) {
+        if (!parser.failed()) [[likely]]
+            parser.scratch<cebu::statement>().push_back(statement);
+    }};
+
+    parser
+        .expect<token_set{
+            token_type::semicolon,
+            token_type::equals_sign,
+            token_type::left_curly_bracket
+        }, on_success_option>([&] {
+            switch (parser.token().type) {
+            case token_type::equals_sign: {
+                statement statement;
+                parse_expression(parser, statement);
+                push(statement);
+            } break;
+            case token_type::left_curly_bracket:
+                // A statement that fails is dropped and parsing resumes at
+                // the next one.  The body is left unclosed if a declaration
+                // keyword or the end is reached.
+                while (parser.lookahead() != token_type::right_curly_bracket
+                       && parser.lookahead() != token_type::end
+                       && parser.lookahead() != determiner_tokens) {
+                    statement statement;
+                    parse_statement(parser, statement);
+                    push(statement);
+                    if (parser.failed()) [[unlikely]]
+                        parser.recover();
+                }
+                parser.expect<token_type::right_curly_bracket>();
+                break;
+            default:
+                break;
+            }
+        });
+    out.statements = parser.collect<statement>(base);
+}
+
+template<typename ...Ts>
+void syntax_parser<body, Ts...>::
+    parse_statement(parser& parser, statement& out)
+{
+    token_type second{parser.lookahead(2).type};
+    if (parser.lookahead() != token_type::name
+        || (second != token_type::colon
+            && second != token_type::left_parenthesis)) {
+        parse_expression(parser, out);
+        return;
+    }
+
+    // A name and a colon is rarely a cast that is thrown away, but a name
+    // and a parenthesis is often an invocation.  If both fail, the one that
+    // got further is parsed again for its diagnostics, since it is likelier
+    // what was meant.  One that nested too deeply counts as getting
+    // furthest, so that the depth limit is reported rather than an error of
+    // what the statement isn't.
+    bool declaration_first{second == token_type::colon};
+    auto parse_either{[&](bool declaration) {
+        if (declaration)
+            parse_declaration(parser, out);
+        else parse_expression(parser, out);
+        return parser.too_deep() ? std::numeric_limits<std::uint32_t>::max()
+                                 : parser.lookahead().offset;
+    }};
+    parser_checkpoint checkpoint{parser.checkpoint()};
+    std::uint32_t reached{parse_either(declaration_first)};
+    if (!parser.failed()) [[likely]] {
+        parser.commit();
+        return;
+    }
+    parser.rewind(checkpoint);
+
+    checkpoint = parser.checkpoint();
+    if (parse_either(!declaration_first) >= reached || !parser.failed()) {
+        parser.commit();
+        return;
+    }
+    parser.rewind(checkpoint);
+    parse_either(declaration_first);
+}
+
+template<typename ...Ts>
+void syntax_parser<body, Ts...>::
+    parse_expression(parser& parser, statement& out)
+{
+    out.type = statement::expression;
+    parser
+        .parse<expression>(out.value.expression)
+        .expect<token_type::semicolon>();
+}
+
+template<typename ...Ts>
+void syntax_parser<body, Ts...>::
+    parse_declaration(parser& parser, statement& out)
+{
+    out.type = statement::declaration;
+    if (!parser.enter_scope(declaration_scopes)) [[unlikely]]
+        return;
+    parser.parse<declaration>(out.value.declaration);
+    parser.exit_scope(declaration_scopes);
+}
+
+template<typename ...Ts>
+void syntax_parser<method_declaration, Ts...>::
+    parse(parser&             parser,
+          method_declaration& out)
+{
+    parser
+        .parse<identifier>(out.identifier)
+        .parse<lambda_type>(out.lambda)
+        .parse<body>(out.body);
+}
+
+template<typename ...Ts>
+void syntax_parser<declaration, Ts...>::
+    parse(parser& parser, declaration& out)
+{
+    // The keyword of a method declaration is optional, and a declaration
+    // without one is a value declaration if a colon follows its name.
+    token_type first{parser.lookahead().type};
+    if (first == token_type::name
+        && parser.lookahead(2) == token_type::colon) {
+        out.type = declaration::value_;
+        out.value.value = parser.arena().make<value_declaration>();
+        parser.parse<value_declaration>(*out.value.value);
+        return;
+    }
+    if (first == token_type::method)
+        parser.consume();
+    else if (first != token_type::name) {
+        parser.expect<token_set{token_type::method, token_type::name}>();
+        return;
+    }
+    out.type = declaration::method;
+    out.value.method = parser.arena().make<method_declaration>();
+    parser.parse<method_declaration>(*out.value.method);
+}
+
+template<typename ...Ts>
+void syntax_parser<program, Ts...>::
+    parse(parser& parser, program& out)
+{
+    while (parser.lookahead() != token_type::end)
+        parse_next(parser, out);
+    parser.flush_diagnostics();
+    if (parser.errors())
+        parser.set_failed();
+}
+
+template<typename ...Ts>
+bool syntax_parser<program, Ts...>::
+    parse_next(parser& parser, program& out)
+{
+    cebu::token first{parser.lookahead()};
+    declaration& declaration{out.declarations.emplace_back()};
+    parser.parse<cebu::declaration>(declaration);
+    if (!parser.failed()) [[likely]]
+        return true;
+
+    out.declarations.pop_back();
+    parser.recover();
+
+    // Recovery stops before a `}` or a declaration keyword, which may be
+    // where the declaration failed, such as a stray `}` or a keyword that
+    // doesn't begin a declaration yet.
+    if (parser.lookahead().offset == first.offset)
+        parser.consume();
+    return false;
+}
+
+template<typename ...Ts>
+void syntax_parser<lambda_type, Ts...>::
+    parse(parser&      parser,
+          lambda_type& out)
+{
+    parser
+        .parse<tuple_type>(out.tuple)
+        .expect<token_type::rightwards_arrow>()
+        .parse<type>(out.return_type);
+}
+
+template<typename ...Ts>
+void syntax_parser<type, Ts...>::
+    run(parser& parser, type_frame root)
+{
+    using step = type_frame::step;
+
+    std::vector<type_frame>& frames{parser.scratch<type_frame>()};
+    std::vector<value_declaration>& mappings{
+        parser.scratch<value_declaration>()
+    };
+    std::size_t base{frames.size()};
+    std::size_t mappings_base{mappings.size()};
+    if (parser.enter_scope())
+        frames.push_back(root);
+    while (frames.size() > base && !parser.failed()) {
+        type_frame& top{frames.back()};
+        auto out{[&]() -> type& {
+            return top.out ? *top.out : mappings[top.mapping].type;
+        }};
+        switch (top.next) {
+        case step::type:
+            // A tuple or lambda type begins with the tuple, and it is a
+            // lambda type if an arrow follows.  The tuple is parsed into a
+            // lambda so that it doesn't have to be moved if it is.
+            if (parser.lookahead() == token_type::left_parenthesis) {
+                top.lambda = parser.arena().make<lambda_type>();
+                top.tuple = &top.lambda->tuple;
+                out().type = type::tuple;
+                out().value.tuple = top.tuple;
+                top.next = step::tuple;
+                continue;
+            }
+            parser
+                .expect<primitive_type_tokens, on_success_option>([&] {
+                    out().type = type::primitive;
+                    out().value.primitive = static_cast<primitive_type>(
+                        parser.token().type);
+                });
+            break;
+        case step::tuple:
+            parser
+                .expect<token_type::left_parenthesis, on_success_option>([&] {
+                    top.base = mappings.size();
+                    top.next = step::mapping;
+                    if (parser.lookahead() == token_type::right_parenthesis) {
+                        parser.consume();
+                        top.next = step::arrow;
+                    }
+                });
+            continue;
+        case step::mapping: {
+            // A mapping of a tuple is a value declaration without a body, or
+            // only a type.
+            std::size_t index{mappings.size()};
+            mappings.emplace_back();
+            if (parser.lookahead() == token_type::name)
+                parser
+                    .parse<identifier>(mappings[index].identifier)
+                    .expect<token_type::colon>();
+            top.next = step::separator;
+            if (parser.enter_scope())
+                frames.push_back({.mapping = index});
+        } continue;
+        case step::separator:
+            parser.expect<token_set{
+                token_type::comma,
+                token_type::right_parenthesis
+            }>();
+            if (parser.token() == token_type::comma)
+                top.next = step::mapping;
+            else {
+                top.tuple->mappings =
+                    parser.collect<value_declaration>(top.base);
+                top.next = step::arrow;
+            }
+            continue;
+        case step::arrow:
+            if (top.lambda
+                && parser.lookahead() == token_type::rightwards_arrow) {
+                // Nothing follows the return type, so it takes the place of
+                // the frame.
+                out().type = type::lambda;
+                out().value.lambda = top.lambda;
+                top = {.out = &top.lambda->return_type};
+                parser.consume();
+                continue;
+            }
+            break;
+        }
+        frames.pop_back();
+        parser.exit_scope();
+    }
+
+    if (frames.size() > base) [[unlikely]] {
+        parser.exit_scope(static_cast<int>(frames.size() - base));
+        frames.resize(base);
+    }
+    mappings.resize(mappings_base);
+}
+
+template<typename ...Ts>
+void syntax_parser<value_declaration, Ts...>::
+    parse(parser& parser, value_declaration& out)
+{
+    parser
+        .parse<identifier>(out.identifier)
+        .expect<token_type::colon>()
+        .parse<type>(out.type)
+        .parse<body>(out.body);
+}
+
+template<typename ...Ts>
+void syntax_parser<expression, Ts...>::
+    parse(parser& parser, expression& out, int precedence)
+{
+    std::vector<frame>& frames{parser.scratch<frame>()};
+    std::size_t base{frames.size()};
+    std::size_t mappings{parser.scratch<mapping>().size()};
+    push(parser, frames, precedence);
+    while (frames.size() > base && !parser.failed()) {
+        frame& top{frames.back()};
+        switch (top.next) {
+        case step::operand:
+            parse_operand(parser, frames);
+            continue;
+        case step::operators:
+            if (parse_operator(parser, frames))
+                continue;
+            break;
+        case step::right_parenthesis:
+            top.next = step::operators;
+            parser.expect<token_type::right_parenthesis>();
+            continue;
+        case step::comma:
+            top.next = step::operators;
+            top.hole = &top.value.value.implication->contrapositive;
+            parser.expect<token_type::comma>();
+            push(parser, frames, implication::precedence);
+            continue;
+        case step::separator:
+            parser.expect<token_set{
+                token_type::comma,
+                token_type::right_parenthesis
+            }>();
+            if (parser.token() == token_type::comma)
+                begin_argument(parser, frames);
+            else if (!parser.failed()) {
+                top.value.value.invocation->arguments =
+                    parser.collect<mapping>(top.base);
+                top.next = step::operators;
+            }
+            continue;
+        }
+
+        // No operator follows, so the expression of the frame is done and
+        // goes where the frame below it said.
+        expression value{top.value};
+        frames.pop_back();
+        parser.exit_scope();
+        if (frames.size() == base) {
+            out = value;
+            return;
+        }
+        frame& below{frames.back()};
+        if (below.hole)
+            *below.hole = value;
+        else parser.scratch<mapping>().push_back({below.name, value});
+    }
+
+    // Parsing failed, so drop what was being built.
+    parser.exit_scope(static_cast<int>(frames.size() - base));
+    frames.resize(base);
+    parser.scratch<mapping>().resize(mappings);
+}
+
+template<typename ...Ts>
+void syntax_parser<expression, Ts...>::
+    parse_operand(parser& parser, std::vector<frame>& frames)
+{
+    frame& top{frames.back()};
+    top.next = step::operators;
+    parser.expect<first, on_success_option>([&] {
+        cebu::token token{parser.token()};
+        literal_table const& literals{parser.literals()};
+        switch (token.type) {
+        case token_type::number: {
+            // Numbers are lexed to 128 bits, which is wider than integers.
+            uint128 number{literals.number(token)};
+            if (number > std::numeric_limits<std::int64_t>::max())
+                [[unlikely]] {
+                parser.report<parsing_error::number_overflow>(token);
+                parser.set_failed();
+                break;
+            }
+            make<integer>(parser, top.value, expression::integer)->value =
+                static_cast<std::int64_t>(number);
+        } break;
+        case token_type::decimal:
+            make<decimal>(parser, top.value, expression::decimal)->value =
+                literals.decimal(token);
+            break;
+        case token_type::character:
+            make<character>(parser, top.value, expression::character)->value =
+                literals.character(token);
+            break;
+        case token_type::string: {
+            std::string_view value{literals.string(token)};
+            if (parser.copies_strings()) [[unlikely]] {
+                std::span<char> copy{parser.arena().copy(
+                    std::span<char const>{value}
+                )};
+                value = {copy.data(), copy.size()};
+            }
+            make<string>(parser, top.value, expression::string)->value =
+                value;
+        } break;
+        case token_type::left_parenthesis:
+            top.hole = &make<parenthesized>(
+                parser, top.value, expression::parenthesized)->expression;
+            top.next = step::right_parenthesis;
+            push(parser, frames, implication::precedence);
+            break;
+        default: {
+            // The rest begin with a path, and what follows the path tells
+            // them apart.
+            path path;
+            parse_path(parser, path);
+            token_type next{parser.lookahead().type};
+            if (next == token_type::left_parenthesis) {
+                make<invocation>(parser, top.value,
+                                 expression::invocation)->path = path;
+                parser.consume();
+                if (parser.lookahead() == token_type::right_parenthesis)
+                    parser.consume();
+                else {
+                    top.base = parser.scratch<mapping>().size();
+                    begin_argument(parser, frames);
+                }
+            } else if (next == token_type::colon
+                       && cast::precedence <= top.precedence) {
+                cast* node{make<cast>(parser, top.value, expression::cast)};
+                node->path = path;
+                parser
+                    .consume()
+                    .parse<type>(node->type);
+            } else if (next == token_type::equals_sign
+                       && assignment::precedence <= top.precedence) {
+                assignment* node{
+                    make<assignment>(parser, top.value, expression::assignment)
+                };
+                node->path = path;
+                top.hole = &node->value;
+                parser.consume();
+                push(parser, frames, assignment::precedence);
+            } else
+                *make<cebu::path>(parser, top.value, expression::path) = path;
+        }
+        }
+    });
+}
+
+template<typename ...Ts>
+bool syntax_parser<expression, Ts...>::
+    parse_operator(parser& parser, std::vector<frame>& frames)
+{
+    frame& top{frames.back()};
+    token_type type{parser.lookahead().type};
+    if (type == token_type::plus_sign
+        && addition::precedence <= top.precedence)
+        push_binary<addition>(parser, frames, expression::addition);
+    else if (type == token_type::minus_sign
+             && subtraction::precedence <= top.precedence)
+        push_binary<subtraction>(parser, frames, expression::subtraction);
+    else if (type == token_type::double_equals_sign
+             && equation::precedence <= top.precedence)
+        push_binary<equation>(parser, frames, expression::equation);
+    else if (type == token_type::vertical_line
+             && disjunction::precedence <= top.precedence)
+        push_binary<disjunction>(parser, frames, expression::disjunction);
+    else if (type == token_type::rightwards_double_arrow
+             && implication::precedence <= top.precedence) {
+        // Implications associate to the right, so both branches allow
+        // another implication.
+        expression condition{top.value};
+        implication* node{
+            make<implication>(parser, top.value, expression::implication)
+        };
+        node->condition = condition;
+        top.hole = &node->consequence;
+        top.next = step::comma;
+        parser.consume();
+        push(parser, frames, implication::precedence);
+    } else return false;
+    return true;
+}
+
+template<typename ...Ts>
+template<typename Operation>
+void syntax_parser<expression, Ts...>::
+    push_binary(parser& parser, std::vector<frame>& frames,
+                expression::type_t type)
+{
+    frame& top{frames.back()};
+    expression left{top.value};
+    Operation* node{make<Operation>(parser, top.value, type)};
+    node->left = left;
+    top.hole = &node->right;
+    parser.consume();
+    push(parser, frames, Operation::precedence - 1);
+}
+
+template<typename ...Ts>
+void syntax_parser<expression, Ts...>::
+    begin_argument(parser& parser, std::vector<frame>& frames)
+{
+    // An argument is named if it begins with a name and a colon, unless a
+    // type follows the colon, in which case it is a cast.
+    static constexpr token_set type_first{
+        primitive_type_tokens | token_set{token_type::left_parenthesis}
+    };
+
+    frame& top{frames.back()};
+    top.next = step::separator;
+    top.hole = nullptr;
+    top.name = {};
+    if (parser.lookahead() == token_type::name
+        && parser.lookahead(2) == token_type::colon) {
+        if (parser.lookahead(3) == type_first && parse_cast_argument(parser))
+            return;
+        parser
+            .parse<identifier>(top.name)
+            .consume();
+    }
+    push(parser, frames, implication::precedence);
+}
+
+template<typename ...Ts>
+bool syntax_parser<expression, Ts...>::
+    parse_cast_argument(parser& parser)
+{
+    // Both a type and an expression may begin with a parenthesis, so the
+    // type is tried and rewound if it isn't one.
+    parser_checkpoint checkpoint{parser.checkpoint()};
+    path path;
+    type type;
+    parser.consume();
+    parse_path(parser, path);
+    parser
+        .consume()
+        .parse<cebu::type>(type);
+    token_type next{parser.lookahead().type};
+    if (parser.failed() || (next != token_type::comma
+                            && next != token_type::right_parenthesis)) {
+        parser.rewind(checkpoint);
+        return false;
+    }
+
+    expression value;
+    cast* node{make<cast>(parser, value, expression::cast)};
+    node->path = path;
+    node->type = type;
+    parser.scratch<mapping>().push_back({{}, value});
+    parser.commit();
+    return true;
+}
+
+template<typename ...Ts>
+void syntax_parser<expression, Ts...>::
+    parse_path(parser& parser, path& out)
+{
+    std::vector<identifier>& identifiers{parser.scratch<identifier>()};
+    std::size_t base{identifiers.size()};
+    identifiers.push_back({
+        parser.literals().name(parser.token()),
+        parser.location()
+    });
+    while (!parser.failed()
+           && parser.lookahead() == token_type::double_colon) {
+        identifier name;
+        parser
+            .consume()
+            .parse<identifier>(name);
+        identifiers.push_back(name);
+    }
+    out.value = parser.collect<identifier>(base);
+}
+
 }
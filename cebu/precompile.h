@@ -1,7 +1,22 @@
 #pragma once
 #define CEBU_INCLUDED_PRECOMPILE_H
 
+#include <cebu/arena.h>
+#include <cebu/character.h>
 #include <cebu/diagnostics.h>
+#include <cebu/document.h>
+#include <cebu/driver.h>
+#include <cebu/flat_syntax.h>
+#include <cebu/interner.h>
+#include <cebu/json.h>
 #include <cebu/lexer.h>
+#include <cebu/literals.h>
 #include <cebu/parser.h>
+#include <cebu/scan.h>
+#include <cebu/server.h>
+#include <cebu/source.h>
+#include <cebu/source_manager.h>
 #include <cebu/syntax.h>
+#include <cebu/thread_pool.h>
+#include <cebu/token_buffer.h>
+#include <cebu/token_ring.h>
@@ -0,0 +1,326 @@
+#include <bit>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#   define CEBU_SCAN_X86 1
+#   include <immintrin.h>
+#endif
+
+#include <cebu/character.h>
+
+#include "scan.h"
+
+namespace cebu
+{
+
+namespace
+{
+
+//
+// Scalar kernels
+//
+
+char const* scan_whitespace_scalar(char const* pointer) noexcept
+{
+    while (is_whitespace(*pointer))
+        ++pointer;
+    return pointer;
+}
+
+char const* scan_name_scalar(char const* pointer) noexcept
+{
+    while (is_name(*pointer))
+        ++pointer;
+    return pointer;
+}
+
+char const* scan_string_scalar(char const* pointer) noexcept
+{
+    while (*pointer != '"' && *pointer != '\\' && *pointer != '\0')
+        ++pointer;
+    return pointer;
+}
+
+/// `scan_line_starts_from` - Scans the line starts of `text` after `index`
+/// one character at a time.
+void scan_line_starts_from(std::string_view             text,
+                           std::size_t                  index,
+                           std::vector<std::uint32_t>& starts)
+{
+    for (; index < text.size(); ++index)
+        if (text[index] == '\n')
+            starts.push_back(static_cast<std::uint32_t>(index + 1));
+}
+
+void scan_line_starts_scalar(std::string_view             text,
+                             std::vector<std::uint32_t>& starts)
+{ scan_line_starts_from(text, 0, starts); }
+
+/// `push_line_starts` - Appends the line start after each newline of the
+/// block at `index` whose newlines are the bits of `mask`.
+template<typename Mask>
+void push_line_starts(Mask                         mask,
+                      std::size_t                  index,
+                      std::vector<std::uint32_t>& starts)
+{
+    for (; mask; mask &= mask - 1)
+        starts.push_back(static_cast<std::uint32_t>(
+            index + static_cast<std::size_t>(std::countr_zero(mask)) + 1
+        ));
+}
+
+#if CEBU_SCAN_X86
+
+//
+// SSE2 kernels
+//
+// Blocks are loaded from aligned addresses so that a load never crosses into
+// the page after the terminator.  The bytes of the first block that come
+// before `pointer` are treated as part of the run.
+//
+// These loads read outside of the text on purpose: before `pointer` and past
+// the terminator, up to the ends of their blocks.  A block is aligned to its
+// size, which divides the page size, so it lies in one page, and that page
+// holds a byte of the text or its terminator, so it is mapped.  No class
+// matches `'\0'`, so no block after the terminator's is loaded.  The reads
+// are safe but not within the allocation, which AddressSanitizer can't tell
+// apart from a bug, so it doesn't instrument the kernels.
+//
+
+#define CEBU_NO_SANITIZE_ADDRESS __attribute__((no_sanitize("address")))
+
+/// `in_range_sse2` - Returns the mask of bytes of `v` in `[low, low + size]`.
+__m128i in_range_sse2(__m128i v, char low, char size) noexcept
+{
+    __m128i offset{_mm_sub_epi8(v, _mm_set1_epi8(low))};
+    return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(size)), offset);
+}
+
+struct whitespace_sse2
+{
+    static __m128i match(__m128i v) noexcept
+    {
+        return _mm_or_si128(in_range_sse2(v, '\t', '\r' - '\t'),
+                            _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+    }
+};
+
+struct name_sse2
+{
+    static __m128i match(__m128i v) noexcept
+    {
+        __m128i lower{_mm_or_si128(v, _mm_set1_epi8(0x20))};
+        return _mm_or_si128(
+            _mm_or_si128(in_range_sse2(lower, 'a', 'z' - 'a'),
+                         in_range_sse2(v, '0', '9' - '0')),
+            _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    }
+};
+
+struct string_sse2
+{
+    static __m128i match(__m128i v) noexcept
+    {
+        __m128i special{_mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+            _mm_cmpeq_epi8(v, _mm_setzero_si128()))};
+        return _mm_xor_si128(special, _mm_set1_epi8(-1));
+    }
+};
+
+template<typename Class>
+CEBU_NO_SANITIZE_ADDRESS
+char const* scan_sse2(char const* pointer) noexcept
+{
+    auto address{reinterpret_cast<std::uintptr_t>(pointer)};
+    auto const* block{
+        reinterpret_cast<__m128i const*>(address & ~std::uintptr_t{15})
+    };
+    unsigned before{(1u << (address & 15)) - 1};
+    for (;; ++block, before = 0) {
+        auto run{static_cast<unsigned>(
+            _mm_movemask_epi8(Class::match(_mm_load_si128(block)))
+        ) | before};
+        if (run != 0xffff)
+            return reinterpret_cast<char const*>(block) + std::countr_one(run);
+    }
+}
+
+void scan_line_starts_sse2(std::string_view             text,
+                           std::vector<std::uint32_t>& starts)
+{
+    // The text is not terminated, so the blocks are loaded unaligned and
+    // never past the end of the text.
+    std::size_t index{0};
+    for (; index + 16 <= text.size(); index += 16) {
+        __m128i v{_mm_loadu_si128(
+            reinterpret_cast<__m128i const*>(text.data() + index)
+        )};
+        push_line_starts(static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))
+        )), index, starts);
+    }
+    scan_line_starts_from(text, index, starts);
+}
+
+//
+// AVX2 kernels
+//
+
+#define CEBU_AVX2 __attribute__((target("avx2")))
+
+CEBU_AVX2
+__m256i in_range_avx2(__m256i v, char low, char size) noexcept
+{
+    __m256i offset{_mm256_sub_epi8(v, _mm256_set1_epi8(low))};
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(size)),
+                             offset);
+}
+
+struct whitespace_avx2
+{
+    CEBU_AVX2
+    static __m256i match(__m256i v) noexcept
+    {
+        return _mm256_or_si256(in_range_avx2(v, '\t', '\r' - '\t'),
+                               _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+    }
+};
+
+struct name_avx2
+{
+    CEBU_AVX2
+    static __m256i match(__m256i v) noexcept
+    {
+        __m256i lower{_mm256_or_si256(v, _mm256_set1_epi8(0x20))};
+        return _mm256_or_si256(
+            _mm256_or_si256(in_range_avx2(lower, 'a', 'z' - 'a'),
+                            in_range_avx2(v, '0', '9' - '0')),
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    }
+};
+
+struct string_avx2
+{
+    CEBU_AVX2
+    static __m256i match(__m256i v) noexcept
+    {
+        __m256i special{_mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+            _mm256_cmpeq_epi8(v, _mm256_setzero_si256()))};
+        return _mm256_xor_si256(special, _mm256_set1_epi8(-1));
+    }
+};
+
+template<typename Class>
+CEBU_AVX2 CEBU_NO_SANITIZE_ADDRESS
+char const* scan_avx2(char const* pointer) noexcept
+{
+    auto address{reinterpret_cast<std::uintptr_t>(pointer)};
+    auto const* block{
+        reinterpret_cast<__m256i const*>(address & ~std::uintptr_t{31})
+    };
+    std::uint32_t before{(std::uint32_t{1} << (address & 31)) - 1};
+    for (;; ++block, before = 0) {
+        auto run{static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(Class::match(_mm256_load_si256(block)))
+        ) | before};
+        if (run != 0xffffffff)
+            return reinterpret_cast<char const*>(block) + std::countr_one(run);
+    }
+}
+
+CEBU_AVX2
+void scan_line_starts_avx2(std::string_view             text,
+                           std::vector<std::uint32_t>& starts)
+{
+    std::size_t index{0};
+    for (; index + 32 <= text.size(); index += 32) {
+        __m256i v{_mm256_loadu_si256(
+            reinterpret_cast<__m256i const*>(text.data() + index)
+        )};
+        push_line_starts(static_cast<std::uint32_t>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))
+        )), index, starts);
+    }
+    scan_line_starts_from(text, index, starts);
+}
+
+#undef CEBU_AVX2
+
+#endif
+
+//
+// Dispatch
+//
+
+struct kernels
+{
+    scan_kernel kernel;
+    char const* (*whitespace)(char const*) noexcept;
+    char const* (*name)(char const*) noexcept;
+    char const* (*string)(char const*) noexcept;
+    void (*line_starts)(std::string_view, std::vector<std::uint32_t>&);
+};
+
+kernels select(scan_kernel kernel) noexcept
+{
+#if CEBU_SCAN_X86
+    __builtin_cpu_init();
+    bool avx2{__builtin_cpu_supports("avx2") != 0};
+    if (kernel == scan_kernel::best)
+        kernel = avx2 ? scan_kernel::avx2 : scan_kernel::sse2;
+    if (kernel == scan_kernel::avx2 && avx2)
+        return {
+            scan_kernel::avx2,
+            scan_avx2<whitespace_avx2>,
+            scan_avx2<name_avx2>,
+            scan_avx2<string_avx2>,
+            scan_line_starts_avx2
+        };
+    if (kernel != scan_kernel::scalar)
+        return {
+            scan_kernel::sse2,
+            scan_sse2<whitespace_sse2>,
+            scan_sse2<name_sse2>,
+            scan_sse2<string_sse2>,
+            scan_line_starts_sse2
+        };
+#else
+    (void)kernel;
+#endif
+    return {
+        scan_kernel::scalar,
+        scan_whitespace_scalar,
+        scan_name_scalar,
+        scan_string_scalar,
+        scan_line_starts_scalar
+    };
+}
+
+kernels active_kernels{select(scan_kernel::best)};
+
+}
+
+scan_kernel use_scan_kernel(scan_kernel kernel) noexcept
+{
+    active_kernels = select(kernel);
+    return active_kernels.kernel;
+}
+
+char const* scan_whitespace(char const* pointer) noexcept
+{ return active_kernels.whitespace(pointer); }
+
+char const* scan_name(char const* pointer) noexcept
+{ return active_kernels.name(pointer); }
+
+char const* scan_string(char const* pointer) noexcept
+{ return active_kernels.string(pointer); }
+
+void scan_line_starts(std::string_view             text,
+                      std::vector<std::uint32_t>& starts)
+{ active_kernels.line_starts(text, starts); }
+
+}
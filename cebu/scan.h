@@ -0,0 +1,63 @@
+#pragma once
+#define CEBU_INCLUDED_SCAN_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace cebu
+{
+
+/// `scan_kernel` - An implementation of the scanning functions.
+enum class scan_kernel
+{
+    scalar,
+    sse2,
+    avx2,
+
+    /// The fastest kernel the processor supports.
+    best
+};
+
+/// `use_scan_kernel` - Makes the scanning functions use `kernel`, or the
+/// fastest supported kernel if `kernel` is unsupported, and returns the
+/// kernel in use.
+///
+/// # Notes
+///
+/// The fastest supported kernel is used by default.  This is not thread-safe
+/// and is meant for benchmarks.
+scan_kernel use_scan_kernel(scan_kernel kernel) noexcept;
+
+/// Scanning functions - Skip runs of characters of a lexical class.
+///
+/// Each function returns a pointer to the first character at or after
+/// `pointer` that does not belong to the run.  The run is always ended by a
+/// `'\0'`, so the vectorized kernels never read past the terminator's
+/// aligned block, which cannot cross into another page.
+
+/// `scan_whitespace` - Skips whitespace.
+[[nodiscard]]
+char const* scan_whitespace(char const* pointer) noexcept;
+
+/// `scan_name` - Skips the characters that can continue a name.
+[[nodiscard]]
+char const* scan_name(char const* pointer) noexcept;
+
+/// `scan_string` - Skips the body of a string up to a `'"'`, `'\\'` or
+/// `'\0'`.
+[[nodiscard]]
+char const* scan_string(char const* pointer) noexcept;
+
+/// `scan_line_starts` - Appends the offset of the character after each
+/// `'\n'` in `text` to `starts`.
+///
+/// # Notes
+///
+/// Unlike the other scanning functions, `text` does not need to be
+/// terminated, since the kernels only read whole blocks inside of `text`
+/// and finish the tail one character at a time.
+void scan_line_starts(std::string_view             text,
+                      std::vector<std::uint32_t>& starts);
+
+}
@@ -0,0 +1,428 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+#include "server.h"
+
+namespace cebu
+{
+
+namespace
+{
+
+/// The error codes of the protocol.
+enum error_code
+{
+    invalid_request = -32600,
+    method_not_found = -32601,
+    server_not_initialized = -32002
+};
+
+/// The kinds of symbols of the protocol.
+enum symbol_kind
+{
+    method_symbol = 6,
+    variable_symbol = 13
+};
+
+constexpr int error_severity{1};
+constexpr int incremental_sync{2};
+
+/// `file_path` - Returns the path of the file at `uri`.
+///
+/// Only `file` URIs are decoded.  The others name the file as they are.
+std::string file_path(std::string_view uri)
+{
+    constexpr std::string_view scheme{"file://"};
+    if (!uri.starts_with(scheme))
+        return std::string{uri};
+
+    // The path begins after the authority, which is usually empty.
+    uri.remove_prefix(scheme.size());
+    uri.remove_prefix(std::min(uri.find('/'), uri.size()));
+    std::string path;
+    path.reserve(uri.size());
+    for (std::size_t i{0}; i < uri.size(); ++i) {
+        unsigned char byte{0};
+        if (uri[i] == '%' && i + 2 < uri.size()
+            && std::from_chars(uri.data() + i + 1, uri.data() + i + 3, byte,
+                               16).ptr == uri.data() + i + 3) {
+            path.push_back(static_cast<char>(byte));
+            i += 2;
+        } else path.push_back(uri[i]);
+    }
+    return path;
+}
+
+/// `is_continuation` - Returns whether `byte` continues a UTF-8 sequence.
+constexpr bool is_continuation(char byte) noexcept
+{ return (static_cast<unsigned char>(byte) & 0xC0) == 0x80; }
+
+/// `utf16_size` - Returns the number of UTF-16 code units of the UTF-8
+/// sequence that begins with `byte`.
+constexpr std::size_t utf16_size(char byte) noexcept
+{ return static_cast<unsigned char>(byte) >= 0xF0 ? 2 : 1; }
+
+}
+
+int server::run(std::istream& in, std::ostream& out)
+{
+    this->m_out = &out;
+    std::string content;
+    while (read(in, content)) {
+        // Malformed content has no id to respond to, so it is dropped.
+        json message;
+        if (!json::parse(content, message)) [[unlikely]]
+            continue;
+        if (this->handle(message))
+            break;
+    }
+    return this->m_shut_down ? 0 : 1;
+}
+
+result server::read(std::istream& in, std::string& content)
+{
+    // The header is a list of fields that ends with an empty line, of which
+    // only the length of the content matters.
+    constexpr std::string_view length_field{"content-length:"};
+    std::size_t length{0};
+    bool found{false};
+    std::string line;
+    for (;;) {
+        if (!std::getline(in, line)) [[unlikely]]
+            return result::failure;
+        if (line.ends_with('\r'))
+            line.pop_back();
+        if (line.empty())
+            break;
+        if (line.size() < length_field.size()
+            || !std::ranges::equal(
+                std::string_view{line}.substr(0, length_field.size()),
+                length_field,
+                [](char left, char right) {
+                    return std::tolower(static_cast<unsigned char>(left))
+                        == right;
+                }))
+            continue;
+
+        std::string_view value{line};
+        value.remove_prefix(length_field.size());
+        value.remove_prefix(std::min(value.find_first_not_of(' '),
+                                     value.size()));
+        auto [end, error]{std::from_chars(value.data(),
+                                          value.data() + value.size(),
+                                          length)};
+        found = error == std::errc{};
+    }
+    if (!found) [[unlikely]]
+        return result::failure;
+
+    content.resize(length);
+    in.read(content.data(), static_cast<std::streamsize>(length));
+    return static_cast<std::size_t>(in.gcount()) == length ? result::success
+                                                           : result::failure;
+}
+
+void server::write(json const& message)
+{
+    std::string content;
+    message.dump(content);
+    *this->m_out << "Content-Length: " << content.size() << "\r\n\r\n"
+                 << content << std::flush;
+}
+
+void server::respond(json const& id, json result)
+{
+    this->write(json{}
+        .set("jsonrpc", "2.0")
+        .set("id", id)
+        .set("result", std::move(result)));
+}
+
+void server::respond_error(json const&      id,
+                           int              code,
+                           std::string_view message)
+{
+    this->write(json{}
+        .set("jsonrpc", "2.0")
+        .set("id", id)
+        .set("error", json{}.set("code", code).set("message", message)));
+}
+
+bool server::handle(json const& message)
+{
+    // Messages without a method are responses, and the server sends no
+    // requests.
+    std::string_view method{message["method"].as_string()};
+    json const* id{message.find("id")};
+    json const& params{message["params"]};
+    if (method.empty())
+        return false;
+    if (method == "exit")
+        return true;
+
+    // Notifications are dropped where requests would be refused.
+    if (!this->m_initialized && method != "initialize") {
+        if (id)
+            this->respond_error(*id, server_not_initialized,
+                                "server not initialized");
+        return false;
+    }
+    if (this->m_shut_down) {
+        if (id)
+            this->respond_error(*id, invalid_request, "server is shut down");
+        return false;
+    }
+
+    if (method == "initialize")
+        this->initialize(id ? *id : json{}, params);
+    else if (method == "shutdown") {
+        this->m_shut_down = true;
+        this->m_documents.clear();
+        this->respond(id ? *id : json{}, nullptr);
+    } else if (method == "textDocument/didOpen")
+        this->open(params);
+    else if (method == "textDocument/didChange")
+        this->change(params);
+    else if (method == "textDocument/didClose")
+        this->close(params);
+    else if (method == "textDocument/documentSymbol")
+        this->document_symbol(id ? *id : json{}, params);
+    else if (id)
+        this->respond_error(*id, method_not_found,
+                            std::format("unknown method: {}", method));
+    return false;
+}
+
+void server::initialize(json const& id, json const& params)
+{
+    // UTF-8 positions save converting every position, and UTF-16 ones are
+    // the default that every client understands.
+    json const& encodings{
+        params["capabilities"]["general"]["positionEncodings"]
+    };
+    this->m_utf8 = std::ranges::any_of(encodings.as_array(),
+                                       [](json const& encoding) {
+        return encoding.as_string() == "utf-8";
+    });
+    this->m_initialized = true;
+
+    json capabilities;
+    capabilities
+        .set("positionEncoding", this->m_utf8 ? "utf-8" : "utf-16")
+        .set("textDocumentSync", json{}
+            .set("openClose", true)
+            .set("change", incremental_sync))
+        .set("documentSymbolProvider", true);
+    this->respond(id, json{}
+        .set("capabilities", std::move(capabilities))
+        .set("serverInfo", json{}.set("name", "cebu")));
+}
+
+void server::open(json const& params)
+{
+    json const& item{params["textDocument"]};
+    std::string uri{item["uri"].as_string()};
+    auto& document{this->m_documents[uri]};
+    document = std::make_unique<open_document>();
+    document->file_path = file_path(uri);
+    document->document
+        .set_diagnostics(document->discard)
+        .set_sink(&document->diagnostics);
+    (void)document->document.assign(document->file_path,
+                                     std::string{item["text"].as_string()});
+    this->publish_diagnostics(uri, *document);
+}
+
+void server::change(json const& params)
+{
+    std::string_view uri{params["textDocument"]["uri"].as_string()};
+    auto found{this->m_documents.find(std::string{uri})};
+    if (found == this->m_documents.end()) [[unlikely]]
+        return;
+
+    // Every change is applied to the text that the changes before it made.
+    // Each edit prints the diagnostics of the whole source, so only those of
+    // the last are kept.
+    open_document& document{*found->second};
+    for (json const& change : params["contentChanges"].as_array()) {
+        document.diagnostics.clear();
+        std::string_view text{change["text"].as_string()};
+        json const* range{change.find("range")};
+        if (!range) {
+            (void)document.document.assign(document.file_path,
+                                           std::string{text});
+            continue;
+        }
+
+        std::size_t first{this->offset(document, (*range)["start"])};
+        std::size_t last{
+            std::max(first, this->offset(document, (*range)["end"]))
+        };
+        document_change changed;
+        if (document.document.edit(static_cast<std::uint32_t>(first),
+                                   static_cast<std::uint32_t>(last - first),
+                                   text, changed)) [[likely]]
+            continue;
+
+        // The edited source didn't fit in the source space of the parser,
+        // which starts over when the source is assigned.
+        std::string contents{document.document.source().view()};
+        contents.replace(first, last - first, text);
+        (void)document.document.assign(document.file_path,
+                                       std::move(contents));
+    }
+    this->publish_diagnostics(uri, document);
+}
+
+void server::close(json const& params)
+{
+    std::string_view uri{params["textDocument"]["uri"].as_string()};
+    this->m_documents.erase(std::string{uri});
+
+    // The diagnostics of a closed file are cleared.
+    this->write(json{}
+        .set("jsonrpc", "2.0")
+        .set("method", "textDocument/publishDiagnostics")
+        .set("params", json{}
+            .set("uri", uri)
+            .set("diagnostics", json::array_type{})));
+}
+
+void server::document_symbol(json const& id, json const& params)
+{
+    std::string_view uri{params["textDocument"]["uri"].as_string()};
+    auto found{this->m_documents.find(std::string{uri})};
+    if (found == this->m_documents.end()) [[unlikely]] {
+        this->respond(id, nullptr);
+        return;
+    }
+
+    // The top-level declarations span their tokens, the last of which is
+    // the `;` or `}` that ends them.
+    open_document& document{*found->second};
+    cebu::program const& program{document.document.program()};
+    json symbols{json::array_type{}};
+    for (std::size_t i{0}; i < program.declarations.size(); ++i) {
+        auto [first, last]{document.document.extent(i)};
+        json symbol{this->symbol(document, program.declarations[i])};
+        symbol.set("range", this->range(document, first, last + 1));
+        symbols.push(std::move(symbol));
+    }
+    this->respond(id, std::move(symbols));
+}
+
+json server::symbol(open_document const& document,
+                    declaration const&   declaration) const
+{
+    bool method{declaration.type == declaration::method};
+    cebu::identifier const& identifier{
+        method ? declaration.value.method->identifier
+               : declaration.value.value->identifier
+    };
+    cebu::body const& body{
+        method ? declaration.value.method->body
+               : declaration.value.value->body
+    };
+
+    // Nested declarations are only located by their names.
+    std::size_t first{
+        document.document.parser().sources().offset(identifier.location)
+    };
+    json name{this->range(document, first, first + identifier.name.size)};
+    json children{json::array_type{}};
+    for (statement const& statement : body.statements)
+        if (statement.type == statement::declaration)
+            children.push(this->symbol(document, statement.value.declaration));
+
+    json symbol;
+    symbol
+        .set("name", identifier.name.view())
+        .set("kind", method ? method_symbol : variable_symbol)
+        .set("range", name)
+        .set("selectionRange", std::move(name))
+        .set("children", std::move(children));
+    return symbol;
+}
+
+void server::publish_diagnostics(std::string_view uri, open_document& document)
+{
+    std::string_view source{document.document.source().view()};
+    json diagnostics{json::array_type{}};
+    for (diagnostic const& diagnostic : document.diagnostics) {
+        // The diagnostic covers the character at its offset, since the
+        // length of what it is about isn't known.
+        std::size_t first{std::min<std::size_t>(diagnostic.offset,
+                                                source.size())};
+        std::size_t after{first};
+        if (after < source.size() && source[after] != '\n')
+            do ++after;
+            while (after < source.size() && is_continuation(source[after]));
+        diagnostics.push(json{}
+            .set("range", this->range(document, first, after))
+            .set("severity", error_severity)
+            .set("source", "cebu")
+            .set("message", diagnostic.message));
+    }
+
+    this->write(json{}
+        .set("jsonrpc", "2.0")
+        .set("method", "textDocument/publishDiagnostics")
+        .set("params", json{}
+            .set("uri", uri)
+            .set("diagnostics", std::move(diagnostics))));
+}
+
+json server::position(open_document const& document, std::size_t offset) const
+{
+    cebu::source const& source{document.document.source()};
+    offset = std::min(offset, source.size());
+    cebu::position position{source.lines().position(offset)};
+    std::size_t character{position.column};
+    if (!this->m_utf8) {
+        character = 0;
+        for (char byte : source.view().substr(offset - position.column,
+                                               position.column))
+            if (!is_continuation(byte))
+                character += utf16_size(byte);
+    }
+    return json{}.set("line", position.row - 1).set("character", character);
+}
+
+std::size_t server::offset(open_document const& document,
+                           json const&          position) const
+{
+    // Positions past the end of a line are the end of the line.
+    auto number{[&](std::string_view key) {
+        return static_cast<std::size_t>(
+            std::max(position[key].as_number(), 0.0)
+        );
+    }};
+    std::size_t row{number("line") + 1};
+    std::size_t character{number("character")};
+    cebu::source const& source{document.document.source()};
+    line_table const& lines{source.lines()};
+    if (this->m_utf8)
+        return lines.offset({row, character});
+
+    std::string_view text{source.view()};
+    std::size_t offset{lines.offset({row, 0})};
+    std::size_t end{lines.offset({row, text.size()})};
+    for (std::size_t units{0}; offset < end && units < character;) {
+        units += utf16_size(text[offset]);
+        do ++offset;
+        while (offset < end && is_continuation(text[offset]));
+    }
+    return offset;
+}
+
+json server::range(open_document const& document,
+                   std::size_t          first,
+                   std::size_t          last) const
+{
+    return json{}
+        .set("start", this->position(document, first))
+        .set("end", this->position(document, last));
+}
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+#define CEBU_INCLUDED_SERVER_H
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <cebu/document.h>
+#include <cebu/json.h>
+
+namespace cebu
+{
+
+/// `server` - A language server that speaks the Language Server Protocol
+/// over a pair of streams.
+///
+/// Every open file is kept as a `document`, so its source, tokens and trees
+/// stay resident between messages.  Changes are applied as edits of the
+/// document, which reparses only what they damaged, and requests are
+/// answered from the parsed program.
+///
+/// The diagnostics of a file are published whenever it is opened or
+/// changed, and its declarations are the symbols of `documentSymbol`.
+///
+/// # Notes
+///
+/// Positions are counted in UTF-8 code units if the client offers them and
+/// in UTF-16 code units otherwise, as the protocol requires.
+///
+/// The server runs on the thread that calls `run`, and handles one message
+/// at a time.
+class server
+{
+public:
+    /// `run` - Reads messages from `in` and writes the responses and
+    /// notifications to `out` until the client exits or `in` ends.
+    ///
+    /// Returns the exit code, which is zero if the client shut the server
+    /// down before it exited.
+    int run(std::istream& in, std::ostream& out);
+
+private:
+    /// `open_document` - A file that the client opened.
+    struct open_document
+    {
+        cebu::document          document;
+
+        /// The diagnostics of the last parse, which the document appends.
+        std::vector<diagnostic> diagnostics;
+
+        /// The stream that the document prints its diagnostics to, which
+        /// discards them since they are published from `diagnostics`.
+        std::ostream            discard{nullptr};
+
+        /// The path that the document was parsed as.
+        std::string             file_path;
+    };
+
+    std::unordered_map<std::string, std::unique_ptr<open_document>>
+                  m_documents;
+    std::ostream* m_out{&std::cout};
+    bool          m_initialized{false};
+    bool          m_shut_down{false};
+    bool          m_utf8{false};
+
+    /// `read` - Reads the content of the next message from `in`.
+    ///
+    /// Returns failure if `in` ended or the header is malformed.
+    static result read(std::istream& in, std::string& content);
+
+    /// `write` - Writes `message` to the output.
+    void write(json const& message);
+
+    /// `respond` - Writes the response to the request `id`.
+    void respond(json const& id, json result);
+
+    /// `respond_error` - Writes the error response to the request `id`.
+    void respond_error(json const& id, int code, std::string_view message);
+
+    /// `handle` - Handles `message`.  Returns whether the client exited.
+    bool handle(json const& message);
+
+    void initialize(json const& id, json const& params);
+    void open(json const& params);
+    void change(json const& params);
+    void close(json const& params);
+    void document_symbol(json const& id, json const& params);
+
+    /// `symbol` - Makes the protocol symbol of `declaration` of `document`,
+    /// whose children are the declarations in its body.
+    json symbol(open_document const& document,
+                declaration const&   declaration) const;
+
+    /// `publish_diagnostics` - Sends the diagnostics of the document at
+    /// `uri`.
+    void publish_diagnostics(std::string_view uri, open_document& document);
+
+    /// `position` - Converts the source offset `offset` of `document` to a
+    /// protocol position.
+    json position(open_document const& document, std::size_t offset) const;
+
+    /// `offset` - Converts the protocol position `position` of `document`
+    /// to a source offset.
+    std::size_t offset(open_document const& document,
+                       json const&          position) const;
+
+    /// `range` - Makes a protocol range from the source offsets `first` to
+    /// `last` of `document`.
+    json range(open_document const& document,
+               std::size_t          first,
+               std::size_t          last) const;
+};
+
+}
@@ -0,0 +1,254 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+
+#include <cebu/scan.h>
+
+#include "source.h"
+
+namespace cebu
+{
+
+source& source::operator=(source&& other) noexcept
+{
+    if (this == &other) [[unlikely]]
+        return *this;
+    this->unload();
+    this->m_file_path = std::move(other.m_file_path);
+    this->m_buffer = std::move(other.m_buffer);
+    this->m_size = other.m_size;
+    this->m_mapping_size = other.m_mapping_size;
+
+    // A buffered source points into its own buffer, which may have moved.
+    this->m_data = this->m_mapping_size ? other.m_data
+                                        : this->m_buffer.data();
+    this->m_lines.reset(this->view());
+    other.m_data = "";
+    other.m_size = 0;
+    other.m_mapping_size = 0;
+    other.m_lines.reset({});
+    return *this;
+}
+
+result source::load(std::string_view file_path, source_backend backend)
+{
+    this->unload();
+    this->m_file_path = file_path;
+    result result{backend == source_backend::mapped ? this->map_file()
+                                                    : this->read_file()};
+    this->m_lines.reset(this->view());
+    return result;
+}
+
+void source::assign(std::string_view file_path, std::string contents)
+{
+    this->unload();
+    this->m_file_path = file_path;
+    this->m_buffer = std::move(contents);
+    this->m_data = this->m_buffer.data();
+    this->m_size = this->m_buffer.size();
+    this->m_lines.reset(this->view());
+}
+
+void source::edit(std::size_t offset, std::size_t removed,
+                  std::string_view inserted)
+{
+    if (this->m_mapping_size) {
+        std::string contents{this->view()};
+        ::munmap(const_cast<char*>(this->m_data), this->m_mapping_size);
+        this->m_mapping_size = 0;
+        this->m_buffer = std::move(contents);
+    }
+    this->m_buffer.replace(offset, removed, inserted);
+    this->m_data = this->m_buffer.data();
+    this->m_size = this->m_buffer.size();
+    this->m_lines.edit(this->view(), offset, removed, inserted.size());
+}
+
+void source::unload() noexcept
+{
+    if (this->m_mapping_size)
+        ::munmap(const_cast<char*>(this->m_data), this->m_mapping_size);
+    this->m_buffer.clear();
+    this->m_data = "";
+    this->m_size = 0;
+    this->m_mapping_size = 0;
+    this->m_lines.reset({});
+}
+
+void line_table::edit(std::string_view text,
+                      std::size_t      offset,
+                      std::size_t      removed,
+                      std::size_t      inserted)
+{
+    this->m_text = text;
+    if (this->m_starts.empty())
+        return;
+
+    // The lines that began after the removed newlines are replaced by those
+    // that begin after the inserted ones, and the lines after them move by
+    // the change in size.
+    std::vector<std::uint32_t> added;
+    scan_line_starts(text.substr(offset, inserted), added);
+    auto first{static_cast<std::size_t>(
+        std::ranges::upper_bound(this->m_starts, offset)
+        - this->m_starts.begin()
+    )};
+    auto last{static_cast<std::size_t>(
+        std::ranges::upper_bound(this->m_starts, offset + removed)
+        - this->m_starts.begin()
+    )};
+    auto delta{static_cast<std::uint32_t>(inserted - removed)};
+    for (std::size_t i{last}; i < this->m_starts.size(); ++i)
+        this->m_starts[i] += delta;
+    for (std::uint32_t& start : added)
+        start += static_cast<std::uint32_t>(offset);
+    if (added.size() > last - first)
+        this->m_starts.insert(this->m_starts.begin() + last,
+                              added.size() - (last - first), 0);
+    else this->m_starts.erase(this->m_starts.begin() + first + added.size(),
+                              this->m_starts.begin() + last);
+    std::ranges::copy(added, this->m_starts.begin() + first);
+}
+
+position line_table::position(std::size_t offset) const
+{
+    auto const& starts{this->starts()};
+    offset = std::min(offset, this->m_text.size());
+
+    // The first line starts at zero, so the line of `offset` is the last
+    // start that is not after it.
+    auto line{std::ranges::upper_bound(starts, offset) - 1};
+    return {
+        static_cast<std::size_t>(line - starts.begin()) + 1,
+        offset - *line
+    };
+}
+
+std::size_t line_table::offset(cebu::position position) const
+{
+    auto const& starts{this->starts()};
+    if (position.row == 0 || position.row > starts.size())
+        return this->m_text.size();
+
+    // A line ends before its newline, or at the end of the text.
+    std::size_t start{starts[position.row - 1]};
+    std::size_t end{position.row < starts.size() ? starts[position.row] - 1
+                                                 : this->m_text.size()};
+    return std::min(start + position.column, end);
+}
+
+std::vector<std::uint32_t> const& line_table::starts() const
+{
+    if (this->m_starts.empty()) [[unlikely]] {
+        this->m_starts.reserve(this->m_text.size() / 32 + 1);
+        this->m_starts.push_back(0);
+        scan_line_starts(this->m_text, this->m_starts);
+    }
+    return this->m_starts;
+}
+
+result source::read_file()
+{
+    std::ifstream file{this->m_file_path, std::ios::binary};
+    if (!file) [[unlikely]]
+        return result::failure;
+
+    // Pipes and character devices can't be measured, and files in procfs
+    // and sysfs measure as empty whatever they hold, so they are read to
+    // their end in chunks.
+    std::streamoff size{
+        file.rdbuf()->pubseekoff(0, std::ios::end, std::ios::in)
+    };
+    if (size <= 0) [[unlikely]] {
+        (void)file.rdbuf()->pubseekpos(0, std::ios::in);
+        return this->read_stream(file);
+    }
+
+    // Read the whole file with a single copy.  `std::string` keeps a `'\0'`
+    // after its contents, which serves as the terminator.  A file that
+    // shrinks while it is read fails rather than leaving garbage in the
+    // buffer.
+    this->m_buffer.resize(static_cast<std::size_t>(size));
+    file.seekg(0);
+    if (!file.read(this->m_buffer.data(), size)) [[unlikely]] {
+        this->m_buffer.clear();
+        return result::failure;
+    }
+    this->m_data = this->m_buffer.data();
+    this->m_size = this->m_buffer.size();
+    return result::success;
+}
+
+result source::read_stream(std::istream& in)
+{
+    constexpr std::size_t chunk_size{1 << 16};
+    std::size_t size{0};
+    do {
+        this->m_buffer.resize(size + chunk_size);
+        in.read(this->m_buffer.data() + size, chunk_size);
+        size += static_cast<std::size_t>(in.gcount());
+    } while (in);
+    if (in.bad()) [[unlikely]] {
+        this->m_buffer.clear();
+        return result::failure;
+    }
+    this->m_buffer.resize(size);
+    this->m_data = this->m_buffer.data();
+    this->m_size = this->m_buffer.size();
+    return result::success;
+}
+
+result source::map_file()
+{
+    int descriptor{::open(this->m_file_path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (descriptor < 0) [[unlikely]]
+        return result::failure;
+
+    struct stat status;
+    if (::fstat(descriptor, &status) < 0) [[unlikely]] {
+        ::close(descriptor);
+        return result::failure;
+    }
+
+    // Only regular files have a size to map.  Pipes, character devices and
+    // process substitutions are read instead, as are files that report no
+    // size, since procfs and sysfs report none for files that have contents.
+    if (!S_ISREG(status.st_mode) || status.st_size == 0) [[unlikely]] {
+        ::close(descriptor);
+        return this->read_file();
+    }
+
+    // Reserve enough zeroed pages for the contents and the terminator, then
+    // map the file over the front of the reservation.  The bytes past the end
+    // of the file are zero whether they fall in the file's last page or in the
+    // reservation, so the terminator is always present.
+    auto size{static_cast<std::size_t>(status.st_size)};
+    auto page_size{static_cast<std::size_t>(::sysconf(_SC_PAGESIZE))};
+    std::size_t mapping_size{(size + page_size) & ~(page_size - 1)};
+    void* base{::mmap(nullptr, mapping_size, PROT_READ,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)};
+    if (base == MAP_FAILED) [[unlikely]] {
+        ::close(descriptor);
+        return result::failure;
+    }
+    if (size && ::mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED,
+                       descriptor, 0) == MAP_FAILED) [[unlikely]] {
+        ::munmap(base, mapping_size);
+        ::close(descriptor);
+        return result::failure;
+    }
+    ::close(descriptor);
+    ::madvise(base, mapping_size, MADV_SEQUENTIAL);
+
+    this->m_data = static_cast<char const*>(base);
+    this->m_size = size;
+    this->m_mapping_size = mapping_size;
+    return result::success;
+}
+
+}
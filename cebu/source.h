@@ -0,0 +1,182 @@
+#pragma once
+#define CEBU_INCLUDED_SOURCE_H
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <cebu/diagnostics.h>
+
+namespace cebu
+{
+
+/// `source_backend` - How the contents of a source are brought into memory.
+enum class source_backend
+{
+    /// The file is read into an owned buffer.
+    buffered,
+
+    /// The file is mapped into memory and lexed out of the page cache.
+    /// Files that aren't regular, such as pipes, are read into a buffer
+    /// instead.
+    mapped
+};
+
+/// `line_table` - The offsets of the lines of a text.
+///
+/// The table is built the first time a position is resolved, so lexing never
+/// tracks lines and sources without diagnostics never pay for it.  Positions
+/// are then resolved with a binary search over the line starts.
+///
+/// # Notes
+///
+/// Resolving a position may build the table, so a table must not be shared
+/// between threads until it is built.
+class line_table
+{
+public:
+    line_table() = default;
+
+    explicit line_table(std::string_view text) noexcept
+        : m_text{text}
+    {}
+
+    /// `reset` - Discards the table and begins tracking `text`.
+    void reset(std::string_view text) noexcept
+    {
+        this->m_text = text;
+        this->m_starts.clear();
+    }
+
+    /// `edit` - Begins tracking `text`, which is the tracked text with the
+    /// `removed` characters at `offset` replaced by `inserted` characters.
+    ///
+    /// A table that was built is updated rather than discarded, so only the
+    /// inserted characters are scanned.
+    void edit(std::string_view text,
+              std::size_t      offset,
+              std::size_t      removed,
+              std::size_t      inserted);
+
+    /// `position` - Returns the position of the character at `offset`.
+    [[nodiscard]]
+    cebu::position position(std::size_t offset) const;
+
+    /// `offset` - Returns the offset of the character at `position`.  A
+    /// column past the end of its line is the end of the line, and a row past
+    /// the last line is the end of the text.
+    [[nodiscard]]
+    std::size_t offset(cebu::position position) const;
+
+    /// `size` - Returns the number of lines.
+    [[nodiscard]]
+    std::size_t size() const
+    { return this->starts().size(); }
+
+private:
+    std::string_view                   m_text;
+    mutable std::vector<std::uint32_t> m_starts;
+
+    std::vector<std::uint32_t> const& starts() const;
+};
+
+/// `source` - The contents of a source file.
+///
+/// The contents are always followed by a `'\0'`, so the lexer can find the
+/// end of the source without a bounds check.  When the source is mapped, the
+/// mapping is over-allocated by at least one zero-filled byte to provide the
+/// terminator.
+///
+/// # Notes
+///
+/// A mapped file must not be truncated while it is loaded.  The pages past
+/// its new end can no longer be read, so touching them raises `SIGBUS`,
+/// which is not handled.  Sources that may be truncated under the parser,
+/// such as files that an editor rewrites in place, should be buffered.
+class source
+{
+public:
+    source() noexcept = default;
+    source(source const&) = delete;
+    source& operator=(source const&) = delete;
+
+    source(source&& other) noexcept
+    { *this = std::move(other); }
+
+    source& operator=(source&& other) noexcept;
+
+    ~source()
+    { this->unload(); }
+
+    /// `load` - Unloads then loads the file at `file_path` using `backend`.
+    result load(std::string_view file_path, source_backend backend);
+
+    /// `assign` - Unloads then makes `contents` the contents of a file at
+    /// `file_path` that is not read from the disk.
+    void assign(std::string_view file_path, std::string contents);
+
+    /// `edit` - Replaces the `removed` characters at `offset` of the
+    /// contents with `inserted`.
+    ///
+    /// # Notes
+    ///
+    /// Slices of the contents are invalidated.  A mapped source is copied
+    /// into a buffer first.
+    void edit(std::size_t offset, std::size_t removed,
+              std::string_view inserted);
+
+    /// `unload` - Releases the contents.
+    void unload() noexcept;
+
+    /// `file_path` - Returns the path of the loaded file.
+    [[nodiscard]]
+    std::string_view file_path() const noexcept
+    { return this->m_file_path; }
+
+    /// `data` - Returns the NUL-terminated contents.
+    [[nodiscard]]
+    char const* data() const noexcept
+    { return this->m_data; }
+
+    /// `size` - Returns the size of the contents excluding the terminator.
+    [[nodiscard]]
+    std::size_t size() const noexcept
+    { return this->m_size; }
+
+    /// `view` - Returns the contents excluding the terminator.
+    [[nodiscard]]
+    std::string_view view() const noexcept
+    { return {this->m_data, this->m_size}; }
+
+    /// `lines` - Returns the line table of the contents.
+    [[nodiscard]]
+    line_table const& lines() const noexcept
+    { return this->m_lines; }
+
+    /// `position` - Returns the position of the character at `offset`.
+    [[nodiscard]]
+    cebu::position position(std::size_t offset) const
+    { return this->m_lines.position(offset); }
+
+    /// `backend` - Returns the backend holding the contents.
+    [[nodiscard]]
+    source_backend backend() const noexcept
+    { return this->m_mapping_size ? source_backend::mapped
+                                  : source_backend::buffered; }
+
+private:
+    std::string m_file_path;
+    std::string m_buffer;
+    char const* m_data{""};
+    std::size_t m_size{0};
+    std::size_t m_mapping_size{0};
+    line_table  m_lines;
+
+    result read_file();
+    result read_stream(std::istream& in);
+    result map_file();
+};
+
+}
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <limits>
+
+#include "source_manager.h"
+
+namespace cebu
+{
+
+source_manager::source_manager()
+{
+    // The empty source of `file_id::none` takes the zero location.
+    this->add({});
+}
+
+file_id source_manager::load(std::string_view file_path,
+                             source_backend   backend)
+{
+    cebu::source source;
+    if (!source.load(file_path, backend)) [[unlikely]]
+        return file_id::none;
+    return this->add(std::move(source));
+}
+
+file_id source_manager::assign(std::string_view file_path,
+                               std::string      contents)
+{
+    cebu::source source;
+    source.assign(file_path, std::move(contents));
+    return this->add(std::move(source));
+}
+
+result source_manager::edit(file_id          file,
+                            std::uint32_t    offset,
+                            std::uint32_t    removed,
+                            std::string_view inserted)
+{
+    auto index{static_cast<std::uint32_t>(file)};
+    cebu::source& source{this->m_sources[index]};
+    if (file == file_id::none || offset > source.size()
+        || removed > source.size() - offset) [[unlikely]]
+        return result::failure;
+
+    bool last{index + 1 == this->m_bases.size()};
+    std::uint64_t end{
+        this->m_bases[index] + source.size() - removed + inserted.size() + 1
+    };
+    std::uint64_t limit{last ? std::numeric_limits<std::uint32_t>::max()
+                             : this->m_bases[index + 1]};
+    if (end > limit) [[unlikely]]
+        return result::failure;
+    source.edit(offset, removed, inserted);
+    if (last)
+        this->m_end = end;
+    return result::success;
+}
+
+void source_manager::release(file_id file) noexcept
+{
+    auto index{static_cast<std::uint32_t>(file)};
+    if (file == file_id::none || index >= this->m_sources.size()) [[unlikely]]
+        return;
+    if (index + 1 < this->m_sources.size()) {
+        this->m_sources[index].unload();
+        return;
+    }
+    this->m_end = this->m_bases.back();
+    this->m_sources.pop_back();
+    this->m_bases.pop_back();
+}
+
+file_id source_manager::file(source_location location) const noexcept
+{
+    // The bases are ascending, so the file is the last one whose base is not
+    // after the location.
+    auto base{std::ranges::upper_bound(this->m_bases,
+                                       static_cast<std::uint32_t>(location))};
+    return static_cast<file_id>(base - this->m_bases.begin() - 1);
+}
+
+location source_manager::resolve(source_location location) const
+{
+    file_id file{this->file(location)};
+    cebu::source const& source{this->source(file)};
+    return {
+        source.file_path(),
+        source.position(this->offset(location))
+    };
+}
+
+file_id source_manager::add(cebu::source&& source)
+{
+    std::uint64_t end{this->m_end + source.size() + 1};
+    if (end > std::numeric_limits<std::uint32_t>::max()) [[unlikely]]
+        return file_id::none;
+
+    auto file{static_cast<file_id>(this->m_sources.size())};
+    this->m_sources.push_back(std::move(source));
+    this->m_bases.push_back(static_cast<std::uint32_t>(this->m_end));
+    this->m_end = end;
+    return file;
+}
+
+}
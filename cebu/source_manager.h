@@ -0,0 +1,133 @@
+#pragma once
+#define CEBU_INCLUDED_SOURCE_MANAGER_H
+
+#include <deque>
+#include <vector>
+
+#include <cebu/diagnostics.h>
+#include <cebu/source.h>
+
+namespace cebu
+{
+
+/// `file_id` - The identifier of a source in a `source_manager`.
+///
+/// `file_id::none` is an empty source without a path, which every manager
+/// has.
+enum class file_id : std::uint32_t
+{
+    none = 0
+};
+
+/// `source_manager` - The sources of a build.
+///
+/// Every source is given a range of a single 32-bit source space, so that
+/// any location in any of the sources is a `source_location`.  A source of
+/// `n` characters takes `n + 1` locations so that its end has a location.
+/// Locations are decoded with a binary search over the ranges and the line
+/// table of the source.
+///
+/// # Notes
+///
+/// Sources stay loaded until they are released or the manager is destroyed,
+/// so locations and slices of sources stay valid.  The source space is
+/// never compacted, so a manager that keeps adding sources without
+/// releasing the last of them eventually fills it.
+class source_manager
+{
+public:
+    source_manager();
+    source_manager(source_manager const&) = delete;
+    source_manager& operator=(source_manager const&) = delete;
+
+    /// `load` - Loads the file at `file_path` using `backend`.
+    ///
+    /// Returns `file_id::none` if the file could not be loaded or the source
+    /// space is full.
+    file_id load(std::string_view file_path, source_backend backend);
+
+    /// `assign` - Adds `contents` as the source of a file at `file_path` that
+    /// is not read from the disk.
+    ///
+    /// Returns `file_id::none` if the source space is full.
+    file_id assign(std::string_view file_path, std::string contents);
+
+    /// `add` - Adds `source`, which was loaded or assigned already.
+    ///
+    /// Returns `file_id::none` if the source space is full.
+    ///
+    /// # Notes
+    ///
+    /// Sources are given their ranges in the order that they are added, so
+    /// sources that are loaded in parallel can still be laid out in a
+    /// deterministic order.
+    file_id add(cebu::source&& source);
+
+    /// `edit` - Replaces the `removed` characters at `offset` of the source
+    /// of `file` with `inserted`.
+    ///
+    /// The file keeps its range of locations, so the locations before the
+    /// edit stay valid.  Returns failure, having changed nothing, if the edit
+    /// is out of the source or the edited source doesn't fit in the range,
+    /// which only the last file can grow past.
+    ///
+    /// # Notes
+    ///
+    /// Slices of the source are invalidated.
+    result edit(file_id          file,
+                std::uint32_t    offset,
+                std::uint32_t    removed,
+                std::string_view inserted);
+
+    /// `release` - Unloads the source of `file`.  If `file` is the last file,
+    /// its range of the source space is given back and its identifier is
+    /// reused by the next source that is added.
+    ///
+    /// # Notes
+    ///
+    /// Locations into the source, and slices of it, are invalidated.
+    void release(file_id file) noexcept;
+
+    /// `source` - Returns the source of `file`.
+    [[nodiscard]]
+    cebu::source const& source(file_id file) const noexcept
+    { return this->m_sources[static_cast<std::uint32_t>(file)]; }
+
+    /// `size` - Returns the number of sources including `file_id::none`.
+    [[nodiscard]]
+    std::size_t size() const noexcept
+    { return this->m_sources.size(); }
+
+    /// `location` - Returns the location of the character at `offset` in
+    /// `file`.
+    [[nodiscard]]
+    source_location location(file_id file, std::uint32_t offset) const noexcept
+    {
+        return static_cast<source_location>(
+            this->m_bases[static_cast<std::uint32_t>(file)] + offset
+        );
+    }
+
+    /// `file` - Returns the file that contains `location`.
+    [[nodiscard]]
+    file_id file(source_location location) const noexcept;
+
+    /// `offset` - Returns the offset of `location` in its file.
+    [[nodiscard]]
+    std::uint32_t offset(source_location location) const noexcept
+    {
+        return static_cast<std::uint32_t>(location)
+             - this->m_bases[static_cast<std::uint32_t>(this->file(location))];
+    }
+
+    /// `resolve` - Decodes `location` into a file path and position.
+    [[nodiscard]]
+    cebu::location resolve(source_location location) const;
+
+private:
+    std::deque<cebu::source>   m_sources;
+    std::vector<std::uint32_t> m_bases;
+    std::uint64_t              m_end{0};
+};
+
+}
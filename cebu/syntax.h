@@ -1,7 +1,12 @@
 #pragma once
 #define CEBU_INCLUDED_SYNTAX_H
 
+#include <span>
+#include <string_view>
+#include <vector>
+
 #include <cebu/diagnostics.h>
+#include <cebu/interner.h>
 #include <cebu/token.h>
 #include <cebu/utilities/type_traits.h>
 
@@ -45,15 +50,23 @@ class statement;
 ///             | implication
 ///             | equation
 /// parenthesized -> '(' expression ')'
-/// path -> name +['::' name]
-/// invocation -> path '(' mapping +[',' mapping] ')'
+/// path -> name *['::' name]
+/// invocation -> path '(' [argument *[',' argument]] ')'
+/// argument -> mapping | expression
 /// cast -> path ':' type
 /// addition -> expression '+' expression
 /// subtraction -> expression '-' expression
-/// equation -> expressiong '==' expression
+/// equation -> expression '==' expression
 /// disjunction -> expression '|' expression
 /// implication -> expression '=>' expression ',' expression
 /// assignment -> path '=' expression
+///
+/// # Precedence
+///
+/// Each expression has the precedence of its `basic_expression`.  An
+/// operator binds tighter than those with a greater precedence, so
+/// `a + b == c` is `(a + b) == c`.  The binary operators associate to the
+/// left, and implications and assignments to the right.
 class expression;
 class binary;
 class integer;
@@ -129,13 +142,14 @@ public:
 class identifier
 {
 public:
-    std::string_view name;
+    interned        name;
+    source_location location{};
 };
 
 class body
 {
 public:
-    std::vector<statement> statements;
+    std::span<statement> statements;
 };
 
 class type
@@ -171,7 +185,7 @@ class path
     : public basic_expression<1>
 {
 public:
-    std::vector<identifier> value;
+    std::span<identifier> value;
 };
 
 class cast
@@ -202,19 +216,22 @@ enum class primitive_type
     b16,
     b32,
     b64,
+    b128,
     i8,
     i16,
     i32,
     i64,
+    i128,
     f16,
     f32,
-    f64
+    f64,
+    f128
 };
 
 class tuple_type
 {
 public:
-    std::vector<value_declaration> mappings;
+    std::span<value_declaration> mappings;
 };
 
 class lambda_type
@@ -266,18 +283,25 @@ public:
         assignment
     };
 
-    operator cebu::path*&()        { return value.path; }
-    operator cebu::invocation*&()  { return value.invocation; }
-    operator cebu::cast*&()        { return value.cast; }
-    operator cebu::addition*&()    { return value.addition; }
-    operator cebu::subtraction*&() { return value.subtraction; }
-    operator cebu::disjunction*&() { return value.disjunction; }
-    operator cebu::implication*&() { return value.implication; }
-    operator cebu::equation*&()    { return value.equation; }
+    operator cebu::integer*&()       { return value.integer; }
+    operator cebu::decimal*&()       { return value.decimal; }
+    operator cebu::character*&()     { return value.character; }
+    operator cebu::string*&()        { return value.string; }
+    operator cebu::parenthesized*&() { return value.parenthesized; }
+    operator cebu::path*&()          { return value.path; }
+    operator cebu::invocation*&()    { return value.invocation; }
+    operator cebu::cast*&()          { return value.cast; }
+    operator cebu::addition*&()      { return value.addition; }
+    operator cebu::subtraction*&()   { return value.subtraction; }
+    operator cebu::disjunction*&()   { return value.disjunction; }
+    operator cebu::implication*&()   { return value.implication; }
+    operator cebu::equation*&()      { return value.equation; }
+    operator cebu::assignment*&()    { return value.assignment; }
 
     union {
         cebu::binary*        binary;
         cebu::integer*       integer;
+        cebu::decimal*       decimal;
         cebu::character*     character;
         cebu::string*        string;
         cebu::parenthesized* parenthesized;
@@ -289,6 +313,7 @@ public:
         cebu::disjunction*   disjunction;
         cebu::implication*   implication;
         cebu::equation*      equation;
+        cebu::assignment*    assignment;
     }      value;
     type_t type;
 };
@@ -328,9 +353,9 @@ public:
 
 class binary         : public basic_literal<std::uint64_t> {};
 class integer        : public basic_literal<std::int64_t> {};
-class decimal: public basic_literal<double> {};
+class decimal        : public basic_literal<double> {};
 class character      : public basic_literal<char> {};
-class string         : public basic_literal<std::vector<char>> {};
+class string         : public basic_literal<std::string_view> {};
 
 class parenthesized
     : public basic_expression<1>
@@ -339,12 +364,25 @@ public:
     cebu::expression expression;
 };
 
+/// `mapping` - An argument of an invocation.
+///
+/// Positional arguments have no name, so the location of their name is the
+/// default location, which no token has.  A name, a colon and a type is a
+/// positional cast rather than a named argument, since a type is not an
+/// expression.
+class mapping
+{
+public:
+    identifier name;
+    expression value;
+};
+
 class invocation
     : public basic_expression<2>
 {
-public:   
-    path                 path;
-    std::vector<mapping> arguments;
+public:
+    path               path;
+    std::span<mapping> arguments;
 };
 
 template<int Precedence>
@@ -358,8 +396,8 @@ public:
 
 class addition    : public basic_binary_expression<6> {};
 class subtraction : public basic_binary_expression<6> {};
-class equation    : public basic_expression<10> {};
-class disjunction : public basic_expression<15> {};
+class equation    : public basic_binary_expression<10> {};
+class disjunction : public basic_binary_expression<15> {};
 
 class implication
     : public basic_expression<16>
@@ -374,8 +412,8 @@ class assignment
     : public basic_expression<16>
 {
 public:
-    path path;
-    body body;
+    cebu::path path;
+    expression value;
 };
 
 class method_declaration
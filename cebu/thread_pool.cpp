@@ -0,0 +1,111 @@
+#include "thread_pool.h"
+
+namespace cebu
+{
+
+thread_pool::~thread_pool()
+{
+    {
+        std::scoped_lock lock{this->m_mutex};
+        this->m_stopping = true;
+    }
+    this->m_started.notify_all();
+}
+
+void thread_pool::dispatch(std::size_t tasks, std::size_t threads, void* fn,
+                           void (*call)(void* fn, std::size_t task))
+{
+    if (this->m_workers.empty()) [[unlikely]] {
+        this->m_ranges.reset(new range[this->m_threads]);
+        this->m_workers.reserve(this->m_threads - 1);
+        for (std::size_t t{1}; t < this->m_threads; ++t)
+            this->m_workers.emplace_back([this, t] { this->serve(t); });
+    }
+
+    // The threads beyond those that the batch is dealt to wake and go back
+    // to sleep, which is cheaper than telling them apart.
+    batch batch{{this->m_ranges.get(), threads}, fn, call};
+    for (std::size_t t{0}; t < threads; ++t) {
+        batch.ranges[t].begin = tasks * t / threads;
+        batch.ranges[t].end = tasks * (t + 1) / threads;
+    }
+    {
+        std::scoped_lock lock{this->m_mutex};
+        this->m_batch = batch;
+        this->m_running = this->m_workers.size();
+        ++this->m_batches;
+    }
+    this->m_started.notify_all();
+    work(batch, 0);
+
+    std::unique_lock lock{this->m_mutex};
+    this->m_finished.wait(lock, [this] { return this->m_running == 0; });
+}
+
+void thread_pool::work(batch const& batch, std::size_t self)
+{
+    if (self >= batch.ranges.size())
+        return;
+    std::size_t task;
+    while (pop(batch.ranges[self], task) || steal(batch.ranges, self, task))
+        batch.call(batch.fn, task);
+}
+
+void thread_pool::serve(std::size_t self)
+{
+    std::size_t served{0};
+    std::unique_lock lock{this->m_mutex};
+    for (;;) {
+        this->m_started.wait(lock, [&] {
+            return this->m_stopping || this->m_batches != served;
+        });
+        if (this->m_stopping)
+            return;
+        served = this->m_batches;
+        batch batch{this->m_batch};
+        lock.unlock();
+        work(batch, self);
+        lock.lock();
+        if (--this->m_running == 0)
+            this->m_finished.notify_one();
+    }
+}
+
+bool thread_pool::pop(range& range, std::size_t& task)
+{
+    std::scoped_lock lock{range.mutex};
+    if (range.begin == range.end)
+        return false;
+    task = range.begin++;
+    return true;
+}
+
+bool thread_pool::steal(std::span<range> ranges, std::size_t thief,
+                        std::size_t& task)
+{
+    // Victims are tried in order from the thief so that thieves spread over
+    // the ranges instead of all robbing the first one.
+    for (std::size_t i{1}; i < ranges.size(); ++i) {
+        range& victim{ranges[(thief + i) % ranges.size()]};
+        std::size_t begin, end;
+        {
+            std::scoped_lock lock{victim.mutex};
+            if (victim.begin == victim.end)
+                continue;
+            begin = victim.begin + (victim.end - victim.begin) / 2;
+            end = victim.end;
+            victim.end = begin;
+        }
+
+        // Only the thief adds to its own range, and it is empty, so nothing
+        // is lost by filling it after the victim is unlocked.
+        std::scoped_lock lock{ranges[thief].mutex};
+        task = begin;
+        ranges[thief].begin = begin + 1;
+        ranges[thief].end = end;
+        return true;
+    }
+    return false;
+}
+
+}
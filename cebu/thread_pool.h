@@ -0,0 +1,140 @@
+#pragma once
+#define CEBU_INCLUDED_THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cebu
+{
+
+/// `thread_pool` - Threads that run the tasks of a batch by work stealing.
+///
+/// The tasks of a batch are indices.  Each thread is dealt a contiguous
+/// range of them, which it runs from the front.  A thread whose range runs
+/// out steals the back half of the range of another thread, so threads that
+/// were dealt cheap tasks help those that were dealt expensive ones.
+///
+/// # Notes
+///
+/// The threads are started by the first batch that needs them, then wait
+/// for the next batch until the pool is destroyed, so a batch only costs a
+/// wake-up per thread.  The calling thread is one of them.  Batches must not
+/// be run by two threads at once, or from the tasks of a batch, except on a
+/// pool of one thread, which runs them on the calling thread without
+/// touching the pool.
+class thread_pool
+{
+public:
+    /// `thread_pool` - Makes a pool of `threads` threads, or of one thread
+    /// per core if `threads` is zero.
+    explicit thread_pool(unsigned threads = 0) noexcept
+        : m_threads{threads ? threads
+                            : std::max(std::thread::hardware_concurrency(),
+                                       1u)}
+    {}
+
+    thread_pool(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+
+    ~thread_pool();
+
+    /// `size` - Returns the number of threads.
+    [[nodiscard]]
+    unsigned size() const noexcept
+    { return this->m_threads; }
+
+    /// `run` - Calls `fn` with each index below `tasks` and returns once
+    /// every call has returned.
+    ///
+    /// # Notes
+    ///
+    /// `fn` is called from many threads at once, and the order of the calls
+    /// is unspecified.
+    template<typename Fn>
+    void run(std::size_t tasks, Fn&& fn);
+
+private:
+    /// `range` - The tasks that are left to a thread.
+    struct range
+    {
+        std::mutex  mutex;
+        std::size_t begin{0};
+        std::size_t end{0};
+    };
+
+    /// `batch` - The tasks that the threads are running.
+    struct batch
+    {
+        std::span<range> ranges;
+        void*            fn{nullptr};
+        void             (*call)(void* fn, std::size_t task){nullptr};
+    };
+
+    unsigned                m_threads;
+    std::unique_ptr<range[]> m_ranges;
+
+    /// Guards the batch, its number and the count of the threads that are
+    /// running it.
+    std::mutex              m_mutex;
+    std::condition_variable m_started;
+    std::condition_variable m_finished;
+    batch                   m_batch;
+    std::size_t             m_batches{0};
+    std::size_t             m_running{0};
+    bool                    m_stopping{false};
+
+    /// Declared last so that they are joined before the rest is destroyed.
+    std::vector<std::jthread> m_workers;
+
+    /// `dispatch` - Deals `tasks` tasks to `threads` threads, which call
+    /// `call` with `fn` and each task, and returns once they are done.  The
+    /// threads are started if they weren't.
+    void dispatch(std::size_t tasks, std::size_t threads, void* fn,
+                  void (*call)(void* fn, std::size_t task));
+
+    /// `work` - Runs the tasks of `batch` as the thread `self` until none
+    /// are left.  A thread that the batch wasn't dealt to does nothing.
+    static void work(batch const& batch, std::size_t self);
+
+    /// `serve` - Runs each batch as the thread `self` until the pool is
+    /// destroyed.
+    void serve(std::size_t self);
+
+    /// `pop` - Takes the first task of `range`.  Returns false if there is
+    /// none.
+    static bool pop(range& range, std::size_t& task);
+
+    /// `steal` - Takes the back half of the range of another thread than
+    /// `thief`, makes the rest of it the range of `thief` and takes its first
+    /// task.  Returns false if every range is empty.
+    static bool steal(std::span<range> ranges, std::size_t thief,
+                      std::size_t& task);
+};
+
+template<typename Fn>
+void thread_pool::run(std::size_t tasks, Fn&& fn)
+{
+    std::size_t threads{std::min<std::size_t>(this->m_threads, tasks)};
+    if (threads <= 1) {
+        for (std::size_t task{0}; task < tasks; ++task)
+            fn(task);
+        return;
+    }
+
+    using function = std::remove_reference_t<Fn>;
+    this->dispatch(
+        tasks,
+        threads,
+        const_cast<void*>(static_cast<void const*>(std::addressof(fn))),
+        [](void* fn, std::size_t task) { (*static_cast<function*>(fn))(task); }
+    );
+}
+
+}
@@ -5,7 +5,9 @@
 #include <array>
 #include <cstdint>
 #include <format>
+#include <initializer_list>
 #include <limits>
+#include <string>
 #include <string_view>
 
 namespace cebu
@@ -22,26 +24,33 @@ enum class token_category
     nondeterminer
 };
 
-enum class token_type
+/// `token_type` - The type of a token.
+///
+/// The values fit in a byte.  Symbolic tokens of a single character have the
+/// value of that character.
+enum class token_type : std::uint8_t
 {
-    none = -1000,
-    name,
-    number,
-    decimal,
-    character,
-    string,
     end = '\0',
     b8 = 1, // 'b8',
     b16,    // 'b16',
     b32,    // 'b32',
     b64,    // 'b64',
+    b128,   // 'b128',
     i8,     // 'i8',
     i16,    // 'i16',
     i32,    // 'i32',
     i64,    // 'i64',
+    i128,   // 'i128',
     f16,    // 'f16',
     f32,    // 'f32',
     f64,    // 'f64',
+    f128,   // 'f128',
+    none = 16,
+    name,
+    number,
+    decimal,
+    character,
+    string,
     equals_sign             = '=',
     plus_sign               = '+',
     minus_sign              = '-',
@@ -61,80 +70,294 @@ enum class token_type
     right_square_bracket    = ']',
     left_curly_bracket      = '{',
     right_curly_bracket     = '}',
-    double_equals_sign      = '=' + '=' + '\x7f',
-    rightwards_double_arrow = '=' + '>' + '\x7f',
-    double_plus_sign        = '+' + '+' + '\x7f',
-    double_minus_sign       = '-' + '-' + '\x7f',
-    rightwards_arrow        = '-' + '>' + '\x7f',
-    double_vertical_line    = '|' + '|' + '\x7f',
-    method = 1000, // 'method'
-    trait,         // 'trait'
-    type,          // 'type'
-    static_,       // 'static'
-    let = 1100,    // 'let'
-    if_,           // 'if'
-    else_,         // 'else'
-    elif,          // 'elif'
-    return_,       // 'return'
-    _ = 1200
+    double_equals_sign      = 128, // '=='
+    rightwards_double_arrow,       // '=>'
+    double_plus_sign,              // '++'
+    double_minus_sign,             // '--'
+    rightwards_arrow,              // '->'
+    double_vertical_line,          // '||'
+    double_colon,                  // '::'
+    method = 160, // 'method'
+    trait,        // 'trait'
+    type,         // 'type'
+    static_,      // 'static'
+    let = 176,    // 'let'
+    if_,          // 'if'
+    else_,        // 'else'
+    elif,         // 'elif'
+    return_,      // 'return'
+    _ = 192
 };
 
-class token
+/// `token_set` - A set of token types.
+///
+/// The set is a bitset indexed by the value of the token types, so testing
+/// a token against any number of alternatives is a single mask test.  It is
+/// usable as a template argument, which lets `parser::expect` build the set
+/// at compile time.
+struct token_set
 {
-    friend class lexer;
-        
-public:
-    bool is_valuable() const noexcept
-    { return type >= token_type::name && type <= token_type::string; }
+    static constexpr std::size_t capacity{
+        std::numeric_limits<std::uint8_t>::max() + 1
+    };
 
-    bool is_delimiter() const noexcept
+    std::array<std::uint64_t, capacity / 64> words{};
+
+    constexpr token_set() noexcept = default;
+
+    constexpr token_set(std::initializer_list<token_type> types) noexcept
     {
-        switch (type) {
-        case token_type::left_parenthesis:
-        case token_type::left_curly_bracket:
-        case token_type::left_square_bracket:
-        case token_type::left_angle_bracket:
-        case token_type::right_parenthesis:
-        case token_type::right_curly_bracket:
-        case token_type::right_square_bracket:
-        case token_type::right_angle_bracket:
-            return true;
-        default:
-            return false;
-        }
+        for (token_type type : types)
+            this->insert(type);
     }
 
-    bool is_punctuator() const noexcept
+    /// `range` - Returns the set of the types from `first` to `last`.
+    [[nodiscard]]
+    static constexpr token_set range(token_type first,
+                                     token_type last) noexcept
     {
-        return !is_delimiter()
-            && static_cast<int>(type) >= 33
-            && static_cast<int>(type) < 1000;
+        token_set set;
+        for (auto type{static_cast<unsigned>(first)};
+             type <= static_cast<unsigned>(last); ++type)
+            set.insert(static_cast<token_type>(type));
+        return set;
     }
 
-    bool is_primitive_type() const noexcept
+    /// `insert` - Adds `type` to the set.
+    constexpr void insert(token_type type) noexcept
     {
-        return type >= token_type::b8
-            && type < static_cast<token_type>(33);
+        auto index{static_cast<std::uint8_t>(type)};
+        this->words[index / 64] |= std::uint64_t{1} << index % 64;
     }
 
-    bool is_determiner() const noexcept
+    /// `contains` - Returns whether `type` is in the set.
+    [[nodiscard]]
+    constexpr bool contains(token_type type) const noexcept
     {
-        return type >= token_type::method
-            && type < token_type::let;
+        auto index{static_cast<std::uint8_t>(type)};
+        return this->words[index / 64] >> index % 64 & 1;
     }
 
-    bool is_nondeterminer() const noexcept
+    friend constexpr token_set operator|(token_set left,
+                                         token_set right) noexcept
+    {
+        for (std::size_t i{0}; i < left.words.size(); ++i)
+            left.words[i] |= right.words[i];
+        return left;
+    }
+
+    friend constexpr token_set operator-(token_set left,
+                                         token_set right) noexcept
     {
-        return type >= token_type::let
-            && type < token_type::_;
+        for (std::size_t i{0}; i < left.words.size(); ++i)
+            left.words[i] &= ~right.words[i];
+        return left;
     }
 
+    friend constexpr bool operator==(token_set const&,
+                                     token_set const&) noexcept = default;
+};
+
+/// Categories of token types.
+
+/// `valuable_tokens` - The tokens with a value.
+inline constexpr token_set valuable_tokens{
+    token_set::range(token_type::name, token_type::string)
+};
+
+/// `delimiter_tokens` - The brackets.
+inline constexpr token_set delimiter_tokens{
+    token_type::left_parenthesis,
+    token_type::left_curly_bracket,
+    token_type::left_square_bracket,
+    token_type::left_angle_bracket,
+    token_type::right_parenthesis,
+    token_type::right_curly_bracket,
+    token_type::right_square_bracket,
+    token_type::right_angle_bracket
+};
+
+/// `punctuator_tokens` - The symbolic tokens that are not brackets.
+inline constexpr token_set punctuator_tokens{
+    token_set::range(static_cast<token_type>('!'),
+                     static_cast<token_type>(
+                         static_cast<unsigned>(token_type::method) - 1))
+  - delimiter_tokens
+};
+
+/// `primitive_type_tokens` - The primitive type keywords.
+inline constexpr token_set primitive_type_tokens{
+    token_set::range(token_type::b8, token_type::f128)
+};
+
+/// `determiner_tokens` - The keywords that begin a declaration.
+inline constexpr token_set determiner_tokens{
+    token_set::range(token_type::method,
+                     static_cast<token_type>(
+                         static_cast<unsigned>(token_type::let) - 1))
+};
+
+/// `nondeterminer_tokens` - The other keywords.
+inline constexpr token_set nondeterminer_tokens{
+    token_set::range(token_type::let,
+                     static_cast<token_type>(
+                         static_cast<unsigned>(token_type::_) - 1))
+};
+
+/// `uint128` - The type of the value of number tokens.
+using uint128 = unsigned __int128;
+
+/// `to_string` - Returns the decimal representation of `value`.
+inline std::string to_string(uint128 value)
+{
+    char digits[40];
+    char* end{std::end(digits)};
+    char* it{end};
+    do *--it = static_cast<char>('0' + value % 10);
+    while (value /= 10);
+    return {it, end};
+}
+
+/// `keyword` - The spelling of a keyword token.
+struct keyword
+{
+    std::string_view spelling;
+    token_type       type;
+};
+
+/// `keywords` - The keyword tokens.
+inline constexpr std::array keywords{
+    keyword{"b8"    , token_type::b8},
+    keyword{"b16"   , token_type::b16},
+    keyword{"b32"   , token_type::b32},
+    keyword{"b64"   , token_type::b64},
+    keyword{"b128"  , token_type::b128},
+    keyword{"i8"    , token_type::i8},
+    keyword{"i16"   , token_type::i16},
+    keyword{"i32"   , token_type::i32},
+    keyword{"i64"   , token_type::i64},
+    keyword{"i128"  , token_type::i128},
+    keyword{"f16"   , token_type::f16},
+    keyword{"f32"   , token_type::f32},
+    keyword{"f64"   , token_type::f64},
+    keyword{"f128"  , token_type::f128},
+    keyword{"method", token_type::method},
+    keyword{"trait" , token_type::trait},
+    keyword{"type"  , token_type::type},
+    keyword{"static", token_type::static_},
+    keyword{"let"   , token_type::let},
+    keyword{"if"    , token_type::if_},
+    keyword{"else"  , token_type::else_},
+    keyword{"elif"  , token_type::elif},
+    keyword{"return", token_type::return_},
+};
+
+/// `keyword_table` - A perfect hash table of `keywords`.
+///
+/// The hash only reads the length and the first and last characters of a
+/// word, and its multiplier is searched for at compile time so that no two
+/// keywords collide.  A lookup is therefore one hash and at most one string
+/// comparison.
+class keyword_table
+{
+public:
+    consteval keyword_table() noexcept
+    {
+        // Start from the golden ratio so that every bit of the key reaches the
+        // top bits of the product.
+        for (m_multiplier = 0x9e3779b1; !try_multiplier(); m_multiplier += 2)
+            if (m_multiplier > 0x9e3779b1 + 100'000)
+                no_perfect_hash_for_the_keywords();
+    }
+
+    /// `find` - Returns the keyword token type of `word` or
+    /// `token_type::none` if `word` is not a keyword.
+    [[nodiscard]]
+    constexpr token_type find(std::string_view word) const noexcept
+    {
+        if (word.size() < min_size || word.size() > max_size)
+            return token_type::none;
+        keyword const& entry{m_entries[hash(word)]};
+        return entry.spelling == word ? entry.type : token_type::none;
+    }
+
+private:
+    static constexpr std::size_t bits{6};
+    static constexpr std::size_t size{1 << bits};
+    static constexpr std::size_t min_size{std::ranges::min(
+        keywords, {}, [](keyword const& k) { return k.spelling.size(); }
+    ).spelling.size()};
+    static constexpr std::size_t max_size{std::ranges::max(
+        keywords, {}, [](keyword const& k) { return k.spelling.size(); }
+    ).spelling.size()};
+
+    std::array<keyword, size> m_entries{};
+    std::uint32_t             m_multiplier{};
+
+    constexpr std::size_t hash(std::string_view word) const noexcept
+    {
+        auto key{static_cast<std::uint32_t>(
+            static_cast<unsigned char>(word.front()) << 16
+          | static_cast<unsigned char>(word.back()) << 8
+          | word.size())};
+        return (key * m_multiplier) >> (32 - bits);
+    }
+
+    /// `no_perfect_hash_for_the_keywords` - Fails the constant evaluation of
+    /// the table, since it is not `constexpr`, without needing exceptions.
+    static void no_perfect_hash_for_the_keywords() noexcept {}
+
+    consteval bool try_multiplier() noexcept
+    {
+        m_entries.fill({"", token_type::none});
+        for (keyword const& k : keywords) {
+            keyword& entry{m_entries[hash(k.spelling)]};
+            if (!entry.spelling.empty())
+                return false;
+            entry = k;
+        }
+        return true;
+    }
+};
+
+/// `keyword_lookup` - The perfect hash table of `keywords`.
+inline constexpr keyword_table keyword_lookup;
+
+/// `find_keyword` - Returns the keyword token type of `word` or
+/// `token_type::none` if `word` is not a keyword.
+[[nodiscard]]
+constexpr token_type find_keyword(std::string_view word) noexcept
+{ return keyword_lookup.find(word); }
+
+class token
+{
+    friend class lexer;
+        
+public:
+    bool is_valuable() const noexcept
+    { return valuable_tokens.contains(type); }
+
+    bool is_delimiter() const noexcept
+    { return delimiter_tokens.contains(type); }
+
+    bool is_punctuator() const noexcept
+    { return punctuator_tokens.contains(type); }
+
+    bool is_primitive_type() const noexcept
+    { return primitive_type_tokens.contains(type); }
+
+    bool is_determiner() const noexcept
+    { return determiner_tokens.contains(type); }
+
+    bool is_nondeterminer() const noexcept
+    { return nondeterminer_tokens.contains(type); }
+
     friend constexpr bool operator==(token const& left, token const& right)
     { return left.type == right.type; }
 
-    template<typename T> friend constexpr
-    bool operator==(token const& left, T const& right)
-    { return *std::find(right.begin(), right.end(), left) == left; }  
+    friend constexpr
+    bool operator==(token const& left, token_set const& right)
+    { return right.contains(left.type); }
 
     friend constexpr
     bool operator==(token const& left, token_type const& right)
@@ -161,27 +384,33 @@ public:
         }
     }
 
-    void discard() const noexcept
-    {
-        if (*this == token_type::string) [[unlikely]]
-            delete value.string.data();
-    }
+    /// `indirect` - The payload bit that marks the rest of the payload as an
+    /// index into a `literal_table`.
+    static constexpr std::uint32_t indirect{1 << 23};
+
+    /// `max_payload` - The largest payload.
+    static constexpr std::uint32_t max_payload{(1 << 24) - 1};
+
+    /// The source offset of the first character of the token.
+    std::uint32_t   offset{0};
 
-    union {
-        std::string_view string;
-        std::size_t      number;
-        double           decimal;
-        char             character;
-    }               value{};
     enum token_type type{token_type::none};
-    std::byte       padding[[maybe_unused]][4];
 
-    operator std::string_view const&() const { return value.string; }
-    operator std::uint64_t const&() const { return value.number; }
-    operator double const&() const { return value.decimal; }
-    operator char const&() const { return value.character; }
+    /// The value of the token, which depends on its type:
+    ///
+    /// - `name`: The symbol of the name.
+    /// - `character`: The character.
+    /// - `number`: The number if it is less than `indirect`.
+    /// - `string`: The length of the string if it is a slice of the source
+    ///   that is shorter than `indirect`.
+    /// - Otherwise, for `number`, `decimal` and `string`: `indirect` and the
+    ///   index of the value in the `literal_table`.
+    /// - Otherwise: Zero.
+    std::uint32_t   payload : 24 = 0;
 };
 
+static_assert(sizeof(token) == 8);
+
 }
 
 namespace std
@@ -204,6 +433,9 @@ struct formatter<cebu::token_type>
         case cebu::token_type::number:
             format += "number";
             break;
+        case cebu::token_type::decimal:
+            format += "decimal";
+            break;
         case cebu::token_type::character:
             format += "character";
             break;
@@ -225,6 +457,9 @@ struct formatter<cebu::token_type>
         case cebu::token_type::b64:
             format += "b64";
             break;
+        case cebu::token_type::b128:
+            format += "b128";
+            break;
         case cebu::token_type::i8:
             format += "i8";
             break;
@@ -237,6 +472,9 @@ struct formatter<cebu::token_type>
         case cebu::token_type::i64:
             format += "i64";
             break;
+        case cebu::token_type::i128:
+            format += "i128";
+            break;
         case cebu::token_type::f16:
             format += "f16";
             break;
@@ -246,6 +484,9 @@ struct formatter<cebu::token_type>
         case cebu::token_type::f64:
             format += "f64";
             break;
+        case cebu::token_type::f128:
+            format += "f128";
+            break;
         case cebu::token_type::equals_sign:
             format += "equals_sign";
             break;
@@ -321,6 +562,9 @@ struct formatter<cebu::token_type>
         case cebu::token_type::double_vertical_line:
             format += "double_vertical_line";
             break;
+        case cebu::token_type::double_colon:
+            format += "double_colon";
+            break;
         case cebu::token_type::method:
             format += "method";
             break;
@@ -348,6 +592,8 @@ struct formatter<cebu::token_type>
         case cebu::token_type::return_:
             format += "return";
             break;
+        case cebu::token_type::_:
+            break;
         }
         return formatter<string>::format(std::format(
             "{}",
@@ -362,25 +608,8 @@ struct formatter<cebu::token>
 {
     auto format(cebu::token const& self, format_context& ctx) const
     {
-        string format{std::format("token:\n\t{}", self.type)};
-        if (self.is_valuable()) {
-            format += "\n\tvalue: ";
-            switch (self.type) {
-            case cebu::token_type::string:
-                format += std::format("\"{}\"", self.value.string);
-                break;
-            case cebu::token_type::name:
-                format += std::format("{}", self.value.string);
-                break;
-            case cebu::token_type::character:
-                format += std::format("'{}'", self.value.character);
-                break;
-            case cebu::token_type::number:
-                format += std::format("{}", self.value.number);
-                break;
-            }
-        }
-        return formatter<string>::format(format, ctx);
+        return formatter<string>::format(
+            std::format("token:\n\t{}", self.type), ctx);
     }
 };
 
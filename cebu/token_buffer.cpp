@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <sstream>
+
+#include "token_buffer.h"
+
+namespace cebu
+{
+
+result token_buffer::lex(lexer& lexer, std::size_t size)
+{
+    this->clear();
+
+    // Most tokens are a few characters long, so this rarely reallocates.
+    std::size_t estimate{size / 4 + 1};
+    this->m_types.reserve(estimate);
+    this->m_offsets.reserve(estimate);
+    this->m_payloads.reserve(estimate);
+
+    bool failed{false};
+    token token;
+    do {
+        if (!lexer.lex(token)) [[unlikely]] {
+            token.type = token_type::none;
+            failed = true;
+        }
+        this->push(token);
+    } while (token != token_type::end);
+    return failed ? result::failure : result::success;
+}
+
+/// `token_buffer::chunk` - Lines of a source that are lexed on their own.
+struct token_buffer::chunk
+{
+    std::uint32_t       begin{0};
+    std::uint32_t       end{0};
+
+    /// The offset after the last token.
+    std::uint32_t       stop{0};
+
+    cebu::interner      interner;
+    literal_table       literals;
+    std::ostringstream  diagnostics;
+    token_buffer        tokens;
+    bool                failed{false};
+
+    /// Whether the chunk was lexed again into the stitched tables, so that
+    /// its values need no translation.
+    bool                relexed{false};
+
+    /// The diagnostics of `diagnostics`, if the lexer has a sink.
+    std::vector<diagnostic> sink;
+
+    /// The stitched symbols of the symbols of `interner`.
+    std::vector<symbol> symbols;
+
+    /// Where the values of `literals` begin in the stitched tables.
+    literal_mark        bases;
+};
+
+std::size_t token_buffer::chunks(std::size_t size, unsigned threads) noexcept
+{
+    // A chunk is at least this big, so that stitching it is cheap next to
+    // lexing it.
+    static constexpr std::size_t min_chunk_size{1 << 20};
+
+    if (threads <= 1)
+        return 1;
+    return std::min<std::size_t>(size / min_chunk_size,
+                                 std::size_t{threads} * 4);
+}
+
+result token_buffer::lex(lexer& lexer, thread_pool& pool)
+{
+    cebu::source const& source{lexer.sources().source(lexer.file())};
+    std::string_view text{source.view()};
+    std::uint32_t begin{lexer.offset()};
+    std::size_t count{chunks(text.size() - begin, pool.size())};
+    if (count <= 1)
+        return this->lex(lexer, text.size() - begin);
+
+    // Diagnostics resolve positions with the line table, which can only be
+    // shared between threads once it is built.
+    (void)source.lines().size();
+
+    // Each chunk ends after a newline so that only the tokens that span
+    // lines can be split.
+    this->clear();
+    std::unique_ptr<chunk[]> chunks{new chunk[count]};
+    for (std::size_t i{0}; i < count; ++i) {
+        std::size_t end{text.size()};
+        if (i + 1 < count) {
+            std::size_t target{
+                begin + (text.size() - begin) * (i + 1) / count
+            };
+            end = std::min(text.find('\n', std::max<std::size_t>(target,
+                                                                  begin)),
+                           text.size() - 1) + 1;
+        }
+        chunks[i].begin = begin;
+        chunks[i].end = static_cast<std::uint32_t>(end);
+        begin = chunks[i].end;
+    }
+
+    pool.run(count, [&](std::size_t i) {
+        chunk& chunk{chunks[i]};
+        cebu::lexer chunk_lexer;
+        chunk.literals.load(text.data(), chunk.interner);
+        chunk_lexer.load(lexer.sources(), lexer.file(), chunk.literals);
+        chunk_lexer.set_diagnostics(chunk.diagnostics);
+        chunk_lexer.set_sink(lexer.sink() ? &chunk.sink : nullptr);
+        chunk_lexer.seek(chunk.begin);
+        chunk.failed = !chunk.tokens.lex_lines(chunk_lexer, chunk.end,
+                                               chunk.stop);
+    });
+
+    // A chunk is right if the last token before it ended before it began.
+    // Otherwise it was split inside that token, or its symbols don't fit in
+    // the payloads or its values in the tables, and it is lexed again where
+    // the token ended, which reports the names and values that don't fit.
+    // Stitching the symbols and values is sequential, but it only costs a
+    // lookup per distinct name and a copy per value that is out of line.
+    literal_table& literals{lexer.literals()};
+    auto stitch_symbols{[&](chunk& chunk) {
+        chunk.symbols.reserve(chunk.interner.size());
+        for (std::size_t s{0}; s < chunk.interner.size(); ++s) {
+            symbol stitched{literals.interner().intern(
+                chunk.interner.lookup(static_cast<symbol>(s))
+            ).symbol};
+            if (static_cast<std::uint32_t>(stitched) > token::max_payload)
+                [[unlikely]]
+                return result::failure;
+            chunk.symbols.push_back(stitched);
+        }
+        return result::success;
+    }};
+    bool failed{false};
+    std::uint32_t resume{chunks[0].begin};
+    std::vector<std::size_t> firsts(count);
+    std::size_t size{0};
+    for (std::size_t i{0}; i < count; ++i) {
+        chunk& chunk{chunks[i]};
+        if (resume > chunk.begin
+            || !stitch_symbols(chunk)
+            || !literals.append(chunk.literals, chunk.bases)) [[unlikely]] {
+            chunk.relexed = true;
+            lexer.seek(resume);
+            chunk.tokens.clear();
+            chunk.failed = !chunk.tokens.lex_lines(lexer, chunk.end,
+                                                   chunk.stop);
+        } else {
+            lexer.diagnostics() << chunk.diagnostics.view();
+            if (lexer.sink())
+                std::ranges::move(chunk.sink,
+                                  std::back_inserter(*lexer.sink()));
+        }
+        resume = std::max(resume, chunk.stop);
+        failed |= chunk.failed;
+        firsts[i] = size;
+        size += chunk.tokens.size();
+    }
+
+    this->m_types.resize(size + 1);
+    this->m_offsets.resize(size + 1);
+    this->m_payloads.resize(size + 1);
+    pool.run(count, [&](std::size_t i) {
+        this->stitch(chunks[i], firsts[i]);
+    });
+    this->m_types[size] = token_type::end;
+    this->m_offsets[size] = static_cast<std::uint32_t>(text.size());
+    this->m_payloads[size] = 0;
+    lexer.seek(static_cast<std::uint32_t>(text.size()));
+    return failed ? result::failure : result::success;
+}
+
+result token_buffer::relex(lexer&        lexer,
+                           std::uint32_t offset,
+                           std::uint32_t removed,
+                           std::uint32_t inserted,
+                           cebu::splice& splice)
+{
+    // The old tokens from `old` on begin after the removed characters, and
+    // are found in the edited source by the change in size.
+    std::uint32_t delta{inserted - removed};
+    auto old{static_cast<std::size_t>(
+        std::ranges::lower_bound(this->m_offsets, offset + removed)
+        - this->m_offsets.begin()
+    )};
+    auto first{static_cast<std::size_t>(
+        std::ranges::lower_bound(this->m_offsets, offset)
+        - this->m_offsets.begin()
+    )};
+    first -= std::min<std::size_t>(first, 2);
+
+    // The end token always resynchronizes, since both sources end there.  The
+    // edit may come before the first token, in the whitespace that leads it.
+    bool failed{false};
+    token_buffer tokens;
+    lexer.seek(std::min(this->m_offsets[first], offset));
+    for (;;) {
+        lexer.skip_whitespace();
+        std::uint32_t at{lexer.offset()};
+        if (at >= offset + inserted) {
+            while (this->m_offsets[old] < at - delta)
+                ++old;
+            if (this->m_offsets[old] == at - delta)
+                break;
+        }
+        token token;
+        if (!lexer.lex(token)) [[unlikely]] {
+            token.type = token_type::none;
+            failed = true;
+        }
+        tokens.push(token);
+    }
+
+    splice = {first, old - first, tokens.size()};
+    auto replace{[&](auto& column, auto const& with) {
+        if (with.size() > splice.removed)
+            column.insert(column.begin() + old,
+                          with.size() - splice.removed, {});
+        else column.erase(column.begin() + first + with.size(),
+                          column.begin() + old);
+        std::ranges::copy(with, column.begin() + first);
+    }};
+    replace(this->m_types, tokens.m_types);
+    replace(this->m_offsets, tokens.m_offsets);
+    replace(this->m_payloads, tokens.m_payloads);
+    for (std::size_t i{first + tokens.size()}; i < this->size(); ++i)
+        this->m_offsets[i] += delta;
+    return failed ? result::failure : result::success;
+}
+
+result token_buffer::lex_lines(lexer& lexer, std::uint32_t end,
+                               std::uint32_t& stop)
+{
+    bool failed{false};
+    stop = lexer.offset();
+    for (;;) {
+        lexer.skip_whitespace();
+        if (lexer.offset() >= end)
+            break;
+        token token;
+        if (!lexer.lex(token)) [[unlikely]] {
+            token.type = token_type::none;
+            failed = true;
+        }
+        this->push(token);
+        stop = lexer.offset();
+    }
+    return failed ? result::failure : result::success;
+}
+
+void token_buffer::stitch(chunk const& chunk, std::size_t first) noexcept
+{
+    token_buffer const& tokens{chunk.tokens};
+    std::copy(tokens.m_types.begin(), tokens.m_types.end(),
+              this->m_types.begin() + first);
+    std::copy(tokens.m_offsets.begin(), tokens.m_offsets.end(),
+              this->m_offsets.begin() + first);
+    if (chunk.relexed) {
+        std::copy(tokens.m_payloads.begin(), tokens.m_payloads.end(),
+                  this->m_payloads.begin() + first);
+        return;
+    }
+
+    auto rebase{[](std::uint32_t payload, std::uint32_t base) {
+        return payload & token::indirect ? payload + base : payload;
+    }};
+    for (std::size_t i{0}; i < tokens.size(); ++i) {
+        std::uint32_t payload{tokens.m_payloads[i]};
+        switch (tokens.m_types[i]) {
+        case token_type::name:
+            payload = static_cast<std::uint32_t>(chunk.symbols[payload]);
+            break;
+        case token_type::number:
+            payload = rebase(payload, chunk.bases.numbers);
+            break;
+        case token_type::decimal:
+            payload = rebase(payload, chunk.bases.decimals);
+            break;
+        case token_type::string:
+            payload = rebase(payload, chunk.bases.strings);
+            break;
+        default:
+            break;
+        }
+        this->m_payloads[first + i] = payload;
+    }
+}
+
+void token_buffer::clear() noexcept
+{
+    this->m_types.clear();
+    this->m_offsets.clear();
+    this->m_payloads.clear();
+}
+
+}
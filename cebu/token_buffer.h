@@ -0,0 +1,146 @@
+#pragma once
+#define CEBU_INCLUDED_TOKEN_BUFFER_H
+
+#include <span>
+#include <vector>
+
+#include <cebu/lexer.h>
+#include <cebu/thread_pool.h>
+
+namespace cebu
+{
+
+/// `splice` - Elements of an array that were replaced by others.
+struct splice
+{
+    /// The index of the first element that was replaced.
+    std::size_t first{0};
+
+    /// The number of elements that were removed from `first` on.
+    std::size_t removed{0};
+
+    /// The number of elements that were inserted at `first`.
+    std::size_t inserted{0};
+};
+
+/// `token_buffer` - The tokens of a whole source.
+///
+/// The tokens are stored as parallel arrays of types, source offsets and
+/// payloads so that walking the tokens only touches the columns that are
+/// needed.  The payloads are the same as the tokens', so values are decoded
+/// with the lexer's `literal_table`.
+///
+/// Tokens that failed to lex are stored as `token_type::none`.  The last
+/// token is always `token_type::end`.
+class token_buffer
+{
+public:
+    token_buffer() = default;
+
+    /// `lex` - Clears the buffer then lexes the rest of `lexer`'s source,
+    /// which is about `size` characters long, into it.
+    ///
+    /// Returns failure if any token failed to lex.
+    result lex(lexer& lexer, std::size_t size);
+
+    /// `lex` - Clears the buffer then lexes the rest of `lexer`'s source in
+    /// chunks of lines on the threads of `pool`.
+    ///
+    /// Each chunk is lexed with a lexer, literal table and interner of its
+    /// own, then the chunks are stitched together in order and their values
+    /// are moved into `lexer`'s tables.  Only strings and characters can span
+    /// lines, so a chunk that was split inside one is detected by the token
+    /// before it running past its start, and is lexed again from the end of
+    /// that token.  Small sources are lexed on the calling thread.
+    ///
+    /// Returns failure if any token failed to lex.
+    ///
+    /// # Notes
+    ///
+    /// The diagnostics of the chunks are buffered and printed to `lexer`'s
+    /// stream and sink in order, so they are the same as if the source was
+    /// lexed on one thread.
+    result lex(lexer& lexer, thread_pool& pool);
+
+    /// `chunks` - Returns the number of chunks that `lex` splits `size`
+    /// characters into on `threads` threads, which is at most one if they
+    /// are lexed on the calling thread.
+    [[nodiscard]]
+    static std::size_t chunks(std::size_t size, unsigned threads) noexcept;
+
+    /// `relex` - Lexes again the tokens that were damaged by replacing the
+    /// `removed` characters at `offset` of the source with `inserted`
+    /// characters, and sets `splice` to the tokens that were replaced.
+    ///
+    /// `lexer` must be loaded with the edited source and the literal table of
+    /// the tokens.  Lexing resumes a token before the edit, since the edit
+    /// may join the token before it, and stops at the first token after the
+    /// edit that begins where an old token began, since the lexer carries no
+    /// state between tokens and the rest of the source is unchanged.  The
+    /// tokens that follow are moved by the change in size.
+    ///
+    /// Returns failure if any of the new tokens failed to lex.
+    result relex(lexer&        lexer,
+                 std::uint32_t offset,
+                 std::uint32_t removed,
+                 std::uint32_t inserted,
+                 cebu::splice& splice);
+
+    /// `clear` - Removes all of the tokens.
+    void clear() noexcept;
+
+    /// `size` - Returns the number of tokens including the end token.
+    [[nodiscard]]
+    std::size_t size() const noexcept
+    { return this->m_types.size(); }
+
+    /// `type` - Returns the type of the token at `index`.
+    [[nodiscard]]
+    token_type type(std::size_t index) const noexcept
+    { return this->m_types[index]; }
+
+    /// `types` - Returns the types of the tokens.
+    [[nodiscard]]
+    std::span<token_type const> types() const noexcept
+    { return this->m_types; }
+
+    /// `offset` - Returns the source offset of the token at `index`.
+    [[nodiscard]]
+    std::uint32_t offset(std::size_t index) const noexcept
+    { return this->m_offsets[index]; }
+
+    /// `at` - Returns the token at `index`.
+    [[nodiscard]]
+    token at(std::size_t index) const noexcept
+    {
+        token token;
+        token.type = this->m_types[index];
+        token.offset = this->m_offsets[index];
+        token.payload = this->m_payloads[index];
+        return token;
+    }
+
+private:
+    struct chunk;
+
+    std::vector<token_type>    m_types;
+    std::vector<std::uint32_t> m_offsets;
+    std::vector<std::uint32_t> m_payloads;
+
+    void push(token const& token)
+    {
+        this->m_types.push_back(token.type);
+        this->m_offsets.push_back(token.offset);
+        this->m_payloads.push_back(token.payload);
+    }
+
+    /// `lex_lines` - Lexes the tokens of `lexer`'s source that begin before
+    /// `end` and sets `stop` to the offset after the last one.
+    result lex_lines(lexer& lexer, std::uint32_t end, std::uint32_t& stop);
+
+    /// `stitch` - Copies the tokens of `chunk` to `first` on, encoding their
+    /// values as in the stitched tables.
+    void stitch(chunk const& chunk, std::size_t first) noexcept;
+};
+
+}
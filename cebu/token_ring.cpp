@@ -0,0 +1,49 @@
+#include "token_ring.h"
+
+namespace cebu
+{
+
+void token_ring::close() noexcept
+{
+    // The producer only wakes when the tail changes, and the consumer won't
+    // pop again, so the tail is bumped to wake it.
+    this->m_closed.store(true, std::memory_order_relaxed);
+    this->m_tail.fetch_add(1, std::memory_order_release);
+    this->m_tail.notify_one();
+}
+
+bool token_ring::wait_for_space() noexcept
+{
+    this->publish();
+    for (;;) {
+        std::size_t tail{this->m_tail.load(std::memory_order_acquire)};
+        if (this->m_closed.load(std::memory_order_relaxed)) [[unlikely]]
+            return false;
+        if (this->m_write - tail < capacity) {
+            this->m_cached_tail = tail;
+            return true;
+        }
+        // The clock is only read when the thread sleeps, which is already
+        // slow.
+        auto start{std::chrono::steady_clock::now()};
+        this->m_tail.wait(tail, std::memory_order_acquire);
+        this->m_producer_waited += std::chrono::steady_clock::now() - start;
+    }
+}
+
+void token_ring::wait_for_tokens() noexcept
+{
+    this->release();
+    for (;;) {
+        std::size_t head{this->m_head.load(std::memory_order_acquire)};
+        if (head != this->m_read) {
+            this->m_cached_head = head;
+            return;
+        }
+        auto start{std::chrono::steady_clock::now()};
+        this->m_head.wait(head, std::memory_order_acquire);
+        this->m_consumer_waited += std::chrono::steady_clock::now() - start;
+    }
+}
+
+}
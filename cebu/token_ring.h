@@ -0,0 +1,135 @@
+#pragma once
+#define CEBU_INCLUDED_TOKEN_RING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+#include <cebu/token.h>
+
+namespace cebu
+{
+
+/// `token_ring` - A lock-free queue of tokens from one producing thread to
+/// one consuming thread.
+///
+/// The producer publishes the tokens in batches and the consumer releases
+/// their slots in batches, so the threads only touch each other's cache
+/// lines once per batch.  A thread that finds the ring full or empty first
+/// publishes what it has, so that the other thread can make progress, then
+/// sleeps until the other thread publishes.
+///
+/// Each side counts the time that it slept, which only the thread of that
+/// side may read until the other thread is joined.
+class token_ring
+{
+public:
+    /// The number of tokens that the ring holds.
+    static constexpr std::size_t capacity{1 << 14};
+
+    /// The number of tokens that are published at once.
+    static constexpr std::size_t batch_size{256};
+
+    token_ring()
+        : m_slots{new token[capacity]}
+    {}
+
+    token_ring(token_ring const&) = delete;
+    token_ring& operator=(token_ring const&) = delete;
+
+    //
+    // Producer
+    //
+
+    /// `push` - Appends `token`, waiting for a free slot if the ring is
+    /// full.  Returns false if the ring was closed.
+    bool push(cebu::token const& token) noexcept
+    {
+        if (this->m_write - this->m_cached_tail == capacity) [[unlikely]]
+            if (!this->wait_for_space())
+                return false;
+        this->m_slots[this->m_write++ & (capacity - 1)] = token;
+        if (this->m_write - this->m_published == batch_size) [[unlikely]]
+            this->publish();
+        return true;
+    }
+
+    /// `publish` - Makes the tokens that were pushed visible to the
+    /// consumer.
+    void publish() noexcept
+    {
+        this->m_published = this->m_write;
+        this->m_head.store(this->m_write, std::memory_order_release);
+        this->m_head.notify_one();
+    }
+
+    //
+    // Consumer
+    //
+
+    /// `pop` - Removes the first token, waiting for one if the ring is
+    /// empty.
+    cebu::token pop() noexcept
+    {
+        if (this->m_read == this->m_cached_head) [[unlikely]]
+            this->wait_for_tokens();
+        cebu::token token{this->m_slots[this->m_read++ & (capacity - 1)]};
+        if (this->m_read - this->m_released == batch_size) [[unlikely]]
+            this->release();
+        return token;
+    }
+
+    /// `close` - Stops the producer, which makes `push` return false.  The
+    /// consumer must not pop after closing the ring.
+    void close() noexcept;
+
+    //
+    // Statistics
+    //
+
+    /// `producer_waited` - Returns the time that the producer slept waiting
+    /// for space.
+    [[nodiscard]]
+    std::chrono::nanoseconds producer_waited() const noexcept
+    { return this->m_producer_waited; }
+
+    /// `consumer_waited` - Returns the time that the consumer slept waiting
+    /// for tokens.
+    [[nodiscard]]
+    std::chrono::nanoseconds consumer_waited() const noexcept
+    { return this->m_consumer_waited; }
+
+private:
+    std::unique_ptr<cebu::token[]> m_slots;
+
+    // Each side's counters are on a cache line of their own.  The counters
+    // count every token that was ever pushed, and are masked into slots.
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    std::size_t                          m_write{0};
+    std::size_t                          m_published{0};
+    std::size_t                          m_cached_tail{0};
+    std::chrono::nanoseconds             m_producer_waited{0};
+
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+    std::size_t                          m_read{0};
+    std::size_t                          m_released{0};
+    std::size_t                          m_cached_head{0};
+    std::chrono::nanoseconds             m_consumer_waited{0};
+    std::atomic<bool>                    m_closed{false};
+
+    /// `release` - Makes the slots that were popped available to the
+    /// producer.
+    void release() noexcept
+    {
+        this->m_released = this->m_read;
+        this->m_tail.store(this->m_read, std::memory_order_release);
+        this->m_tail.notify_one();
+    }
+
+    bool wait_for_space() noexcept;
+
+    void wait_for_tokens() noexcept;
+};
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+#define CEBU_INCLUDED_UTILITIES_SEGMENTED_VECTOR_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace cebu
+{
+
+/// `segmented_vector` - An array of `T`s whose elements never move.
+///
+/// The elements are stored in segments that double in size, so growing
+/// never reallocates an element or the table of segments.  One thread may
+/// therefore read the elements that were published to it while another
+/// thread appends more, which a `std::vector` would reallocate under it.
+///
+/// # Notes
+///
+/// `clear` and `resize` keep the segments, so a vector that is refilled
+/// doesn't allocate again.
+template<typename T>
+class segmented_vector
+{
+    static_assert(std::is_trivially_copyable_v<T>
+                  && std::is_trivially_destructible_v<T>);
+
+public:
+    segmented_vector() = default;
+
+    /// `push_back` - Appends `value`.
+    void push_back(T const& value)
+    {
+        auto [segment, offset]{locate(this->m_size)};
+        if (!this->m_segments[segment]) [[unlikely]]
+            this->m_segments[segment].reset(new T[first_size << segment]);
+        this->m_segments[segment][offset] = value;
+        ++this->m_size;
+    }
+
+    [[nodiscard]]
+    T const& operator[](std::size_t index) const noexcept
+    {
+        auto [segment, offset]{locate(index)};
+        return this->m_segments[segment][offset];
+    }
+
+    /// `size` - Returns the number of elements.
+    [[nodiscard]]
+    std::size_t size() const noexcept
+    { return this->m_size; }
+
+    /// `resize` - Removes the elements from `size` on.
+    void resize(std::size_t size) noexcept
+    { this->m_size = std::min(this->m_size, size); }
+
+    /// `clear` - Removes every element.
+    void clear() noexcept
+    { this->m_size = 0; }
+
+private:
+    static constexpr std::size_t first_size{64};
+
+    struct location
+    {
+        std::size_t segment;
+        std::size_t offset;
+    };
+
+    // Segment `k` holds `first_size << k` elements, so it begins at
+    // `first_size * (2^k - 1)` and holds the indices whose `index /
+    // first_size + 1` has `k + 1` bits.
+    static location locate(std::size_t index) noexcept
+    {
+        std::size_t segment{static_cast<std::size_t>(
+            std::bit_width(index / first_size + 1) - 1
+        )};
+        return {
+            segment,
+            index - first_size * ((std::size_t{1} << segment) - 1)
+        };
+    }
+
+    std::array<std::unique_ptr<T[]>, 32> m_segments;
+    std::size_t                          m_size{0};
+};
+
+}
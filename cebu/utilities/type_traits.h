@@ -18,6 +18,9 @@ struct find_type<T> : std::false_type {};
 template<typename T, typename ...Ts>
 struct find_type<T, T, Ts...> : std::true_type {};
 
+template<typename T, typename U, typename ...Ts>
+struct find_type<T, U, Ts...> : find_type<T, Ts...> {};
+
 template<typename T, typename ...Ts>
 static constexpr bool find_type_v = find_type<T, Ts...>::value;
 
@@ -18,4 +18,14 @@ target("cebu", {
     kind = "binary",
     files = "cebu/**.cpp",
     pcxxheader = "cebu/precompile.h",
+    exceptions = "no-cxx",
+    syslinks = "pthread",
+})
+
+target("cebu-bench", {
+    kind = "binary",
+    default = false,
+    files = {"cebu/**.cpp|main.cpp", "bench/**.cpp"},
+    pcxxheader = "cebu/precompile.h",
+    syslinks = "pthread",
 })